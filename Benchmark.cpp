@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Components.h"
+#include "MeshOptimizer.h"
+
+/*
+  - Renderer benchmark
+  - Runs headless scene presets, measures frame times, triangle throughput and heap allocations per frame
+  - Writes results as JSON and compares them against stored baseline
+
+  - Benchmark.cpp:
+  - Contains preset scenes and main realisation
+
+  - Build:
+  - Linux: g++ -std=c++14 -O2 Benchmark.cpp -o benchmark -lEGL -lGL -lGLU -pthread
+  - Windows: compile Benchmark.cpp alone as console application, link opengl32.lib, glu32.lib
+  - Usage:
+  - benchmark [--frames N] [--instances N] [--out results.json] [--baseline baseline.json] [--threshold 0.10] [--filter text]
+  - Exit code is 2 if any preset is slower than baseline by more than threshold
+*/
+
+#define BenchmarkSizeX		1280
+#define BenchmarkSizeY		720
+#define BenchmarkWarmupFrames	10	// driver compiles shader variants lazily during first frames
+
+//Heap allocation counter. Replaces every form of global allocation functions of this executable, so all of them stay paired.
+//Counted on main thread and job system workers, so driver threads (e.g. llvmpipe rasterizer, shader compiler) do not add noise.
+//Frame arena and aligned stream memory bypass operator new, RunPreset() adds their own counters
+
+#ifdef _MSC_VER
+#define BenchmarkNoInline	__declspec(noinline)
+#else
+#define BenchmarkNoInline	__attribute__((noinline))
+#endif
+
+static std::atomic<size_t> heapAllocations(0);
+static thread_local bool isCountedThread = false;
+
+//Out of line, so compiler does not pair inlined malloc and free with new and delete expressions
+static BenchmarkNoInline void* CountedAllocate(size_t size) {
+	if (isCountedThread || JobSystem::IsWorkerThread()) { heapAllocations.fetch_add(1, std::memory_order_relaxed); }
+	return std::malloc(size ? size : 1);
+}
+static BenchmarkNoInline void CountedFree(void* memory) { std::free(memory); }
+
+void* operator new(size_t size) {
+	void* memory = CountedAllocate(size);
+	if (!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+void* operator new[](size_t size) {
+	void* memory = CountedAllocate(size);
+	if (!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void operator delete(void* memory) noexcept { CountedFree(memory); }
+void operator delete[](void* memory) noexcept { CountedFree(memory); }
+void operator delete(void* memory, size_t) noexcept { CountedFree(memory); }
+void operator delete[](void* memory, size_t) noexcept { CountedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { CountedFree(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { CountedFree(memory); }
+
+#ifdef __cpp_aligned_new
+static BenchmarkNoInline void* CountedAlignedAllocate(size_t size, std::align_val_t alignment) {
+	if (isCountedThread || JobSystem::IsWorkerThread()) { heapAllocations.fetch_add(1, std::memory_order_relaxed); }
+	const size_t bytes = (size_t)alignment > sizeof(void*) ? (size_t)alignment : sizeof(void*);
+#ifdef _WIN32
+	return _aligned_malloc(size ? size : 1, bytes);
+#else
+	void* memory = nullptr;
+	return posix_memalign(&memory, bytes, size ? size : 1) == 0 ? memory : nullptr;
+#endif
+}
+static BenchmarkNoInline void CountedAlignedFree(void* memory) {
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	void* memory = CountedAlignedAllocate(size, alignment);
+	if (!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+	void* memory = CountedAlignedAllocate(size, alignment);
+	if (!memory) { throw std::bad_alloc(); }
+	return memory;
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return CountedAlignedAllocate(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return CountedAlignedAllocate(size, alignment); }
+void operator delete(void* memory, std::align_val_t) noexcept { CountedAlignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { CountedAlignedFree(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { CountedAlignedFree(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { CountedAlignedFree(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { CountedAlignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { CountedAlignedFree(memory); }
+#endif
+
+///<summary>
+///Returns heap allocations made so far, that are not tracked per frame by the renderer
+///</summary>
+static size_t CountAllocations(void) { return heapAllocations.load(std::memory_order_relaxed) + AlignedMemory::GetAllocationCount(); }
+
+typedef struct BenchmarkResult {
+	std::string name;
+	size_t trianglesPerFrame;
+	double mean, p50, p90, p99;			// milliseconds
+	double trianglesPerSecond;
+	double allocationsPerFrame;
+} BenchmarkResult;
+
+typedef struct BenchmarkSettings {
+	int frames = 60;
+	int instances = 64;
+	double threshold = 0.10;
+	const char* outputPath = "benchmark.json";
+	const char* baselinePath = nullptr;
+	const char* filter = nullptr;
+} BenchmarkSettings;
+
+///<summary>
+///Returns value at given percentile [0; 1] of sorted list using nearest rank
+///</summary>
+static double Percentile(const std::vector<double>& sorted, double percentile) {
+	if (sorted.empty()) { return 0; }
+	size_t rank = (size_t)(percentile * sorted.size() + 0.5);
+	if (rank > 0) { --rank; }
+	return sorted[rank < sorted.size() ? rank : sorted.size() - 1];
+}
+
+///<summary>
+///Renders given draw function for amount of frames and collects statistics. Waits for GPU at the end of each frame
+///</summary>
+template <typename DrawFunction>
+static BenchmarkResult RunPreset(Renderer& renderer, const std::string& name, size_t trianglesPerFrame, const BenchmarkSettings& settings, DrawFunction draw) {
+	typedef std::chrono::steady_clock Clock;
+	std::vector<double> frameTimes;
+	frameTimes.reserve(settings.frames);
+
+	for (int warmup = 0; warmup < BenchmarkWarmupFrames; ++warmup) {
+		renderer.BeginFrame();
+		draw();
+		renderer.EndFrame();
+		glFinish();
+	}
+
+	const size_t allocationsBefore = CountAllocations();
+	size_t arenaAllocations = 0;
+	for (int frame = 0; frame < settings.frames; ++frame) {
+		const Clock::time_point start = Clock::now();
+		renderer.BeginFrame();
+		draw();
+		renderer.EndFrame();
+		glFinish();
+		frameTimes.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		arenaAllocations += renderer.GetFrameAllocations();
+	}
+	const size_t allocations = CountAllocations() - allocationsBefore + arenaAllocations;
+
+	BenchmarkResult result;
+	result.name = name;
+	result.trianglesPerFrame = trianglesPerFrame;
+
+	double total = 0;
+	for (size_t i = 0; i < frameTimes.size(); ++i) { total += frameTimes[i]; }
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	result.mean = total / frameTimes.size();
+	result.p50 = Percentile(frameTimes, 0.50);
+	result.p90 = Percentile(frameTimes, 0.90);
+	result.p99 = Percentile(frameTimes, 0.99);
+	result.trianglesPerSecond = result.mean > 0 ? trianglesPerFrame / (result.mean / 1000.0) : 0;
+	result.allocationsPerFrame = (double)allocations / settings.frames;
+	return result;
+}
+
+///<summary>
+///Returns position of instance with given index on a square grid around the origin
+///</summary>
+static Vector3 InstancePosition(int index, int instances) {
+	const int side = (int)ceilf(sqrtf((float)instances));
+	const float spacing = 2.5f;
+	const float offset = (side - 1) * spacing / 2.0f;
+	return Vector3((index % side) * spacing - offset, 0, (index / side) * spacing - offset);
+}
+
+static bool IsSelected(const BenchmarkSettings& settings, const std::string& name) {
+	return !settings.filter || name.find(settings.filter) != std::string::npos;
+}
+
+static std::vector<BenchmarkResult> RunAll(Renderer& renderer, const BenchmarkSettings& settings) {
+	std::vector<BenchmarkResult> results;
+	const int instances = settings.instances;
+
+	const char* meshNames[] = { "cuboid", "cone", "cylinder", "icosphere" };
+	Mesh meshes[] = {
+		Mesh::GenerateCuboid(Vector3(2, 2, 2)),
+		Mesh::GenerateCone(32, 1, 2),
+		Mesh::GenerateCylinder(32, 1, 2),
+		Mesh::GenerateIcoSphere(1)
+	};
+	const char* materialNames[] = { "unlit", "diffuse", "realistic", "faceorient" };
+	Material materials[] = {
+		Material(Material::unlit),
+		Material(Material::diffuse, 0.1f, 0.2f),
+		Material(Material::realistic, 0.3f, 1.0f),
+		Material(Material::faceorient, 0.1f, 0.2f)
+	};
+	const Quaternion rotation = Quaternion::EulerAngles(0, PI / 4, 0);
+	const Color color = Color(150, 220, 10);
+
+	std::string name = "grid";
+	if (IsSelected(settings, name)) {
+		const unsigned lines = (unsigned)instances * 8;
+		results.push_back(RunPreset(renderer, name, 0, settings, [&]() {
+			renderer.RenderGrid(-10, 10, lines, -10, 10, lines, 0, false, Color(50, 50, 50));
+		}));
+	}
+
+	name = "points";
+	if (IsSelected(settings, name)) {
+		std::vector<Vector3> points;
+		for (int i = 0; i < instances * 1000; ++i) { points.push_back(Vector3(sinf(i * 0.37f) * 10, cosf(i * 0.11f) * 3 + 3, sinf(i * 0.23f) * 10)); }
+		results.push_back(RunPreset(renderer, name, 0, settings, [&]() {
+			renderer.RenderPoints(points, Color(220, 150, 10));
+		}));
+	}
+
+	for (int m = 0; m < 4; ++m) {
+		const size_t triangles = meshes[m].triangles.size() / 3 * instances;
+		MeshHandle handle = renderer.UploadMesh(meshes[m]);
+
+		for (int k = 0; k < 4; ++k) {
+			name = std::string("mesh_immediate_") + meshNames[m] + "_" + materialNames[k];
+			if (IsSelected(settings, name)) {
+				results.push_back(RunPreset(renderer, name, triangles, settings, [&]() {
+					for (int i = 0; i < instances; ++i) { renderer.RenderMesh(meshes[m], InstancePosition(i, instances), rotation, color, materials[k]); }
+				}));
+			}
+
+			name = std::string("mesh_buffer_") + meshNames[m] + "_" + materialNames[k];
+			if (IsSelected(settings, name)) {
+				renderer.SetGpuShading(false);
+				results.push_back(RunPreset(renderer, name, triangles, settings, [&]() {
+					for (int i = 0; i < instances; ++i) { renderer.RenderMesh(handle, InstancePosition(i, instances), rotation, color, materials[k]); }
+				}));
+				renderer.SetGpuShading(true);
+			}
+
+			name = std::string("mesh_gpu_") + meshNames[m] + "_" + materialNames[k];
+			if (IsSelected(settings, name) && renderer.IsGpuShadingAvailable()) {
+				results.push_back(RunPreset(renderer, name, triangles, settings, [&]() {
+					for (int i = 0; i < instances; ++i) { renderer.RenderMesh(handle, InstancePosition(i, instances), rotation, color, materials[k]); }
+				}));
+			}
+		}
+		renderer.DestroyMesh(handle);
+	}
+
+	//Dense mesh as generated and after vertex cache and vertex fetch reordering. Same triangles, fewer vertex shader runs.
+	//Cache miss ratio is reported for uploaded indices, which include duplicated provoking vertices
+	{
+		Mesh dense = Mesh::GenerateIcoSphere(1, 4);
+		Mesh optimized = dense;
+		MeshOptimizer::Optimize(optimized);
+		MeshHandle handles[2] = { renderer.UploadMesh(dense), renderer.UploadMesh(optimized) };
+		const Mesh* meshes[2] = { &dense, &optimized };
+		const char* orderNames[] = { "generated", "optimized" };
+
+		for (int o = 0; o < 2; ++o) {
+			name = std::string("dense_") + orderNames[o] + "_icosphere_diffuse";
+			if (IsSelected(settings, name)) {
+				const GpuMesh* uploaded = renderer.GetUploadedMesh(handles[o]);
+				printf("%s: ACMR %.3f uploaded, %.3f source\n", name.c_str(),
+					MeshOptimizer::AverageCacheMissRatio(uploaded->indices, uploaded->vertexCount), MeshOptimizer::AverageCacheMissRatio(meshes[o]->triangles, meshes[o]->vertices.size()));
+				results.push_back(RunPreset(renderer, name, dense.triangles.size() / 3 * instances, settings, [&]() {
+					for (int i = 0; i < instances; ++i) { renderer.RenderMesh(handles[o], InstancePosition(i, instances), rotation, color, materials[1]); }
+				}));
+			}
+			renderer.DestroyMesh(handles[o]);
+		}
+	}
+
+	//Icosphere subdivision levels 5..0 as level of detail chain. Error of a level is sagitta of its edge arc on unit sphere
+	LodMesh lodMesh;
+	for (int level = 5; level >= 0; --level) { lodMesh.AddLevel(Mesh::GenerateIcoSphere(1, level), level == 5 ? 0 : 1 - cosf(1.1071487f / (1 << level) / 2)); }
+	LodHandle lodHandle = renderer.UploadLod(lodMesh);
+	std::vector<LodState> lodStates(instances);
+
+	size_t lodTriangles = 0;
+	for (int i = 0; i < instances; ++i) {
+		lodTriangles += lodMesh.Select(lodStates[i], renderer.camera.GetPixelsPerUnit(InstancePosition(i, instances), BenchmarkSizeY), 1.0f, 0.25f).triangles.size() / 3;
+	}
+
+	name = "lod_buffer_icosphere_diffuse";
+	if (IsSelected(settings, name)) {
+		results.push_back(RunPreset(renderer, name, lodTriangles, settings, [&]() {
+			for (int i = 0; i < instances; ++i) { renderer.RenderMesh(lodHandle, lodStates[i], InstancePosition(i, instances), rotation, color, materials[1]); }
+		}));
+	}
+	renderer.DestroyLod(lodHandle);
+
+	//Every mesh with every material in one instanced draw
+	std::vector<Transform> transforms;
+	std::vector<Color> colors(instances, color);
+	for (int i = 0; i < instances; ++i) { transforms.push_back(Transform(InstancePosition(i, instances), rotation)); }
+	for (int m = 0; m < 4; ++m) {
+		MeshHandle handle = renderer.UploadMesh(meshes[m]);
+		for (int k = 0; k < 4; ++k) {
+			name = std::string("instanced_") + meshNames[m] + "_" + materialNames[k];
+			if (IsSelected(settings, name)) {
+				results.push_back(RunPreset(renderer, name, meshes[m].triangles.size() / 3 * instances, settings, [&]() {
+					renderer.RenderMeshInstanced(handle, transforms, colors, materials[k]);
+				}));
+			}
+		}
+		renderer.DestroyMesh(handle);
+	}
+
+	//Every mesh with every material merged into one static batch, both shading paths
+	for (int m = 0; m < 4; ++m) {
+		for (int k = 0; k < 4; ++k) {
+			const std::string cpuName = std::string("batch_cpu_") + meshNames[m] + "_" + materialNames[k];
+			const std::string gpuName = std::string("batch_gpu_") + meshNames[m] + "_" + materialNames[k];
+			if (!IsSelected(settings, cpuName) && !IsSelected(settings, gpuName)) { continue; }
+
+			StaticBatch batch(materials[k]);
+			batch.Reserve(instances);
+			for (int i = 0; i < instances; ++i) { batch.Add(meshes[m], transforms[i], colors[i]); }
+			BatchHandle handle = renderer.UploadBatch(batch);
+
+			if (IsSelected(settings, cpuName)) {
+				renderer.SetGpuShading(false);
+				results.push_back(RunPreset(renderer, cpuName, batch.GetTriangleCount(), settings, [&]() { renderer.RenderBatch(handle); }));
+				renderer.SetGpuShading(true);
+			}
+
+			if (IsSelected(settings, gpuName) && renderer.IsGpuShadingAvailable()) {
+				results.push_back(RunPreset(renderer, gpuName, batch.GetTriangleCount(), settings, [&]() { renderer.RenderBatch(handle); }));
+			}
+			renderer.DestroyBatch(handle);
+		}
+	}
+
+	//Dynamic entities: parallel velocity update, then linear render of world chunks
+	name = "world_cuboid_diffuse";
+	if (IsSelected(settings, name)) {
+		MeshHandle cuboid = renderer.UploadMesh(meshes[0]);
+		World world;
+		world.Reserve(instances);
+		for (int i = 0; i < instances; ++i) {
+			Entity entity = world.Create(World::transform | World::mesh | World::material | World::color | World::velocity);
+			world.SetTransform(entity, Transform(InstancePosition(i, instances), rotation));
+			world.SetMesh(entity, cuboid);
+			world.SetMaterial(entity, materials[1]);
+			world.SetColor(entity, color);
+			world.SetVelocity(entity, Velocity(Vector3(), Vector3(0, 1, 0)));
+		}
+		results.push_back(RunPreset(renderer, name, meshes[0].triangles.size() / 3 * instances, settings, [&]() {
+			world.ApplyVelocities(1.0f / 60.0f);
+			renderer.RenderWorld(world);
+		}));
+		renderer.DestroyMesh(cuboid);
+	}
+
+	//Same instances placed behind the camera. Should cost only the culling test
+	name = "culled_icosphere_diffuse";
+	if (IsSelected(settings, name)) {
+		const Mesh& sphere = meshes[3];
+		results.push_back(RunPreset(renderer, name, 0, settings, [&]() {
+			for (int i = 0; i < instances; ++i) { renderer.RenderMesh(sphere, InstancePosition(i, instances) + Vector3(0, 0, 60), rotation, color, materials[1]); }
+		}));
+	}
+	return results;
+}
+
+static bool WriteJson(const char* path, const std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings) {
+	FILE* file = fopen(path, "w");
+	if (!file) { return false; }
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+	fprintf(file, "  \"frames\": %d,\n", settings.frames);
+	fprintf(file, "  \"instances\": %d,\n", settings.instances);
+	fprintf(file, "  \"presets\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& r = results[i];
+		fprintf(file, "    { \"name\": \"%s\", \"triangles_per_frame\": %zu, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"triangles_per_sec\": %.0f, \"allocations_per_frame\": %.2f }%s\n",
+			r.name.c_str(), r.trianglesPerFrame, r.mean, r.p50, r.p90, r.p99, r.trianglesPerSecond, r.allocationsPerFrame, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	fclose(file);
+	return true;
+}
+
+static std::string ReadFile(const char* path) {
+	std::string text;
+	FILE* file = fopen(path, "rb");
+	if (!file) { return text; }
+
+	char buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) { text.append(buffer, read); }
+	fclose(file);
+	return text;
+}
+
+///<summary>
+///Finds numeric field of preset with given name in JSON written by WriteJson(). Returns false if not found
+///</summary>
+static bool FindBaselineValue(const std::string& json, const std::string& preset, const char* field, double& value) {
+	const size_t presetPosition = json.find("\"name\": \"" + preset + "\"");
+	if (presetPosition == std::string::npos) { return false; }
+
+	const size_t end = json.find('}', presetPosition);
+	const size_t fieldPosition = json.find(std::string("\"") + field + "\":", presetPosition);
+	if (fieldPosition == std::string::npos || fieldPosition > end) { return false; }
+
+	value = strtod(json.c_str() + fieldPosition + strlen(field) + 3, nullptr);
+	return true;
+}
+
+///<summary>
+///Prints comparison with baseline. Returns amount of presets, whose median frame time regressed more than threshold
+///</summary>
+static int CompareWithBaseline(const std::vector<BenchmarkResult>& results, const BenchmarkSettings& settings) {
+	const std::string baseline = ReadFile(settings.baselinePath);
+	if (baseline.empty()) { fprintf(stderr, "Can not read baseline %s\n", settings.baselinePath); return 0; }
+
+	int regressions = 0;
+	printf("\n%-40s %10s %10s %8s\n", "preset", "base p50", "p50", "change");
+	for (size_t i = 0; i < results.size(); ++i) {
+		double baseP50, baseAllocations = 0;
+		if (!FindBaselineValue(baseline, results[i].name, "p50_ms", baseP50) || baseP50 <= 0) {
+			printf("%-40s %10s %10.3f %8s\n", results[i].name.c_str(), "-", results[i].p50, "new");
+			continue;
+		}
+		FindBaselineValue(baseline, results[i].name, "allocations_per_frame", baseAllocations);
+
+		const double change = results[i].p50 / baseP50 - 1.0;
+		const bool isSlower = change > settings.threshold;
+		const bool allocatesMore = results[i].allocationsPerFrame > baseAllocations + 0.5;
+		if (isSlower || allocatesMore) { ++regressions; }
+
+		printf("%-40s %10.3f %10.3f %+7.1f%%%s%s\n", results[i].name.c_str(), baseP50, results[i].p50, change * 100,
+			isSlower ? "  REGRESSION" : "", allocatesMore ? "  MORE ALLOCATIONS" : "");
+	}
+	return regressions;
+}
+
+int main(int argc, char** argv) {
+	isCountedThread = true;
+	BenchmarkSettings settings;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (!strcmp(argv[i], "--frames")) { settings.frames = atoi(argv[i + 1]); }
+		else if (!strcmp(argv[i], "--instances")) { settings.instances = atoi(argv[i + 1]); }
+		else if (!strcmp(argv[i], "--out")) { settings.outputPath = argv[i + 1]; }
+		else if (!strcmp(argv[i], "--baseline")) { settings.baselinePath = argv[i + 1]; }
+		else if (!strcmp(argv[i], "--threshold")) { settings.threshold = atof(argv[i + 1]); }
+		else if (!strcmp(argv[i], "--filter")) { settings.filter = argv[i + 1]; }
+		else { fprintf(stderr, "Unknown option %s\n", argv[i]); return 1; }
+	}
+	if (settings.frames < 1 || settings.instances < 1) { fprintf(stderr, "frames and instances must be positive\n"); return 1; }
+
+	RenderContext renderContext;
+	if (!renderContext.CreateOffscreen(BenchmarkSizeX, BenchmarkSizeY) || !renderContext.MakeCurrent()) { fprintf(stderr, "RenderContext::CreateOffscreen() failed\n"); return 1; }
+	printf("%s, OpenGL %s\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+
+	Renderer renderer = Renderer(Camera(Vector3(0, 18, 18), Vector3(0, 0, 0)));
+	renderer.init();
+
+	std::vector<BenchmarkResult> results = RunAll(renderer, settings);
+
+	printf("\n%-40s %12s %9s %9s %9s %14s %8s\n", "preset", "triangles", "p50 ms", "p90 ms", "p99 ms", "triangles/s", "allocs");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& r = results[i];
+		printf("%-40s %12zu %9.3f %9.3f %9.3f %14.0f %8.2f\n", r.name.c_str(), r.trianglesPerFrame, r.p50, r.p90, r.p99, r.trianglesPerSecond, r.allocationsPerFrame);
+	}
+
+	if (!WriteJson(settings.outputPath, results, settings)) { fprintf(stderr, "Can not write %s\n", settings.outputPath); }
+	else { printf("\nResults written to %s\n", settings.outputPath); }
+
+	int exitCode = 0;
+	if (settings.baselinePath && CompareWithBaseline(results, settings) > 0) { exitCode = 2; }
+
+	renderContext.Destroy();
+	return exitCode;
+}
@@ -1,21 +1,38 @@
 #pragma once
 
+#include <atomic>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
 #include <vector>
-#include <gl/freeglut.h>
+#include "Platform.h"
 #include "Geometry.h"
 #include "Graphics.h"
+#include "GLExtensions.h"
+#include "Memory.h"
+#include "Shaders.h"
+#include "Jobs.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
 
 /*
   - Component system header
   - Provides easy interact, easy to use components and tools to setup and render OpenGL scene
   
   - Components.h:
-  - Uses freeglut functions, creates a component system
+  - Uses OpenGL and GLU functions, creates a component system
   
   - Dependencies:
+  - Platform.h
   - Geometry.h
   - Graphics.h
+  - GLExtensions.h
+  - Memory.h
+  - Shaders.h
+  - Jobs.h
+  - Profiler.h
+  - GpuProfiler.h
 */
 
 class Camera {
@@ -25,12 +42,16 @@ private:
 	float orthoHalfWidth, orthoHalfHeight;
 	float clipNear, clipFar;
 	bool isOrtho;
+	unsigned version = 0;
+	mutable unsigned frustumVersion = ~0u;
+	mutable Frustum frustum;
 
 public:
 	///<summary>
 	///Perspective camera settings. To enable perspective mode call SetPerspective()
 	///</summary>
 	void SetupPerspective(float FOV, float ScreenRatio, float NearClip, float FarClip) {
+		++version;
 		perspectiveFov = FOV;
 		perspectiveRatio = ScreenRatio;
 		clipNear = NearClip;
@@ -40,6 +61,7 @@ public:
 	///Ortho camera settings. To enable ortho mode call SetOrtho()
 	///</summary>
 	void SetupOrtho(float planeWidth, float planeHeight, float NearClip, float FarClip) {
+		++version;
 		orthoHalfHeight = planeHeight / 2.0f;
 		orthoHalfWidth = planeWidth / 2.0f;
 		clipNear = NearClip;
@@ -69,28 +91,73 @@ public:
 	Vector3 GetCameraPosition(void) const { return position; }
 	Vector3 GetTargetPosition(void) const { return target; }
 	///<summary>
+	///Returns counter, that changes each time camera settings are changed. Compare it to know if camera must be redrawn
+	///</summary>
+	unsigned GetVersion(void) const { return version; }
+	///<summary>
 	///Returns normalized camera look direction
 	///</summary>
 	Vector3 Normal(void) const { return (Vector3(target) - Vector3(position)).Normal(); }
+	///<summary>
+	///Returns world space view volume of current mode. Cached until camera settings change
+	///</summary>
+	const Frustum& GetFrustum(void) const {
+		if (frustumVersion == version) { return frustum; }
+		frustumVersion = version;
+
+		const Vector3 forward = Normal();
+		const Vector3 right = Vector3::Cross(forward, axis).Normal();
+		const Vector3 up = Vector3::Cross(right, forward);
+
+		if (isOrtho) {
+			frustum.planes[0] = Plane(right, Vector3(position) - Vector3(right) * orthoHalfWidth);
+			frustum.planes[1] = Plane(Vector3(right) * -1, Vector3(position) + Vector3(right) * orthoHalfWidth);
+			frustum.planes[2] = Plane(up, Vector3(position) - Vector3(up) * orthoHalfHeight);
+			frustum.planes[3] = Plane(Vector3(up) * -1, Vector3(position) + Vector3(up) * orthoHalfHeight);
+		}
+		else {
+			//Side planes pass through camera position. Vertical field of view, horizontal one follows from screen ratio
+			const float tanHalfY = tanf(Quaternion::Deg2Rad(perspectiveFov) / 2);
+			const float tanHalfX = tanHalfY * perspectiveRatio;
+			frustum.planes[0] = Plane(Vector3(forward) * tanHalfX + right, position);
+			frustum.planes[1] = Plane(Vector3(forward) * tanHalfX - right, position);
+			frustum.planes[2] = Plane(Vector3(forward) * tanHalfY + up, position);
+			frustum.planes[3] = Plane(Vector3(forward) * tanHalfY - up, position);
+		}
+		frustum.planes[4] = Plane(forward, Vector3(position) + Vector3(forward) * clipNear);
+		frustum.planes[5] = Plane(Vector3(forward) * -1, Vector3(position) + Vector3(forward) * clipFar);
+		return frustum;
+	}
+	///<summary>
+	///Returns amount of screen pixels covered by one world unit at given point, for viewport of given height in pixels
+	///</summary>
+	float GetPixelsPerUnit(const Vector3& point, float viewportHeight) const {
+		if (isOrtho) { return viewportHeight / (2 * orthoHalfHeight); }
+
+		const float depth = Vector3::Dot(Vector3(point) - position, Normal());
+		const float tanHalfFov = tanf(Quaternion::Deg2Rad(perspectiveFov) / 2);
+		return viewportHeight / (2 * tanHalfFov * (depth > clipNear ? depth : clipNear));
+	}
 
 	///<summary>
 	///Sets new axis for this Camera
 	///</summary>
-	void SetAxis(Vector3 newAxis) { axis = newAxis; }
+	void SetAxis(Vector3 newAxis) { axis = newAxis; ++version; }
 	///<summary>
 	///Sets new position of this Camera
 	///</summary>
-	void SetCameraPosition(Vector3 newPosition) { position = newPosition; }
+	void SetCameraPosition(Vector3 newPosition) { position = newPosition; ++version; }
 	///<summary>
 	///Sets new position of this Camera's target
 	///</summary>
-	void SetTargetPosition(Vector3 newPosition) { target = newPosition; }
+	void SetTargetPosition(Vector3 newPosition) { target = newPosition; ++version; }
 	///<summary>
 	///Sets new clipping distances for this Camera
 	///</summary>
 	void SetClipDistance(float NearClip, float FarClip) {
 		clipNear = NearClip;
 		clipFar = FarClip;
+		++version;
 	}
 	///<summary>
 	///Sets Perspective Camera mode For settings call SetupPerspective()
@@ -98,6 +165,7 @@ public:
 	void SetPerspective(void) {
 		gluPerspective(perspectiveFov, perspectiveRatio, clipNear, clipFar);
 		isOrtho = false;
+		++version;
 	}
 	///<summary>
 	///Sets Ortho Camera mode. For settings call SetupOrtho()
@@ -105,6 +173,7 @@ public:
 	void SetOrtho(void) {
 		glOrtho(-orthoHalfWidth, orthoHalfWidth, -orthoHalfHeight, orthoHalfHeight, clipNear, clipFar);
 		isOrtho = true;
+		++version;
 	}
 	///<summary>
 	///Updates current Camera mode
@@ -114,11 +183,441 @@ public:
 		else { SetPerspective(); }
 	}
 };
+///<summary>
+///Reference to a mesh uploaded to the Renderer mesh cache. Obtain with Renderer::UploadMesh()
+///</summary>
+typedef struct MeshHandle {
+	unsigned id;
+
+	MeshHandle() { id = 0; }
+	MeshHandle(unsigned Id) { id = Id; }
+
+	bool IsValid(void) const { return id != 0; }
+} MeshHandle;
+
+///<summary>
+///Level of detail chain uploaded to the Renderer mesh cache. Obtain with Renderer::UploadLod()
+///</summary>
+typedef struct LodHandle {
+	std::vector<MeshHandle> levels;
+	std::vector<float> errors;
+} LodHandle;
+
+///<summary>
+///Static batch uploaded to the Renderer mesh cache. Obtain with Renderer::UploadBatch()
+///</summary>
+typedef struct BatchHandle {
+	MeshHandle mesh;
+	Material material;
+} BatchHandle;
+
+///<summary>
+///Mesh stored in vertex and index buffer objects. Each triangle's last index (flat shading provoking vertex) is unique, so per-face colors can be streamed per vertex
+///</summary>
+typedef struct GpuMesh {
+	GLuint vertexBuffer, indexBuffer, colorBuffer;
+	///<summary>
+	///Face normal of each triangle stored at its provoking vertex. Used by GLSL programs
+	///</summary>
+	GLuint normalBuffer;
+	///<summary>
+	///Face colors of batched mesh stored at provoking vertices. 0 for meshes colored per draw
+	///</summary>
+	GLuint faceColorBuffer;
+	GLsizei indexCount;
+	///<summary>
+	///Type of indices in index buffer: GL_UNSIGNED_SHORT when every vertex index fits in 16 bits, GL_UNSIGNED_INT otherwise
+	///</summary>
+	GLenum indexType;
+	unsigned vertexCount;
+	bool inUse;
+	///<summary>
+	///Object space face normals, used to light faces without transforming vertices
+	///</summary>
+	std::vector<Vector3> faceNormals;
+	///<summary>
+	///Host copies of the streams. Used for lighting and when buffer objects are unavailable
+	///</summary>
+	std::vector<float> positions;
+	std::vector<unsigned> indices;
+	///<summary>
+	///Face colors of batched mesh. Empty for meshes colored per draw
+	///</summary>
+	std::vector<ColorRange> colorRanges;
+	BoundingSphere bounds;
+
+	GpuMesh() { vertexBuffer = 0; indexBuffer = 0; colorBuffer = 0; normalBuffer = 0; faceColorBuffer = 0; indexCount = 0; indexType = GL_UNSIGNED_INT; vertexCount = 0; inUse = false; }
+} GpuMesh;
+
+#define EntityChunkCapacity 1024
+
+///<summary>
+///Reference to an entity in World. Generation tells apart entities, that reused the same slot
+///</summary>
+typedef struct Entity {
+	unsigned index, generation;
+
+	Entity() { index = ~0u; generation = 0; }
+	Entity(unsigned Index, unsigned Generation) { index = Index; generation = Generation; }
+} Entity;
+
+typedef struct Velocity {
+	Vector3 linear;
+	///<summary>
+	///Rotation speed around each world axis in radians per second
+	///</summary>
+	Vector3 angular;
+
+	Velocity() { linear = Vector3(); angular = Vector3(); }
+	Velocity(const Vector3& Linear, const Vector3& Angular) { linear = Linear; angular = Angular; }
+} Velocity;
+
+///<summary>
+///Up to EntityChunkCapacity entities of one archetype. Every component is a separate contiguous array, arrays of absent components are empty
+///</summary>
+typedef struct EntityChunk {
+	unsigned mask;
+	size_t count;
+	std::vector<Entity> entities;
+
+	std::vector<Vector3> positions;
+	std::vector<Quaternion> rotations;
+	std::vector<Vector3> scales;
+	std::vector<MeshHandle> meshes;
+	std::vector<Material> materials;
+	std::vector<Color> colors;
+	std::vector<Velocity> velocities;
+
+	EntityChunk(unsigned componentMask);
+
+	bool Has(unsigned components) const { return (mask & components) == components; }
+} EntityChunk;
+
+///<summary>
+///Archetype based entity storage. Entities with the same set of components are packed together in chunks, so systems and renderer iterate arrays linearly
+///</summary>
+class World {
+public:
+	enum Component {
+		transform = 1,		// position, rotation, scale
+		mesh = 2,			// MeshHandle
+		material = 4,
+		color = 8,
+		velocity = 16
+	};
+
+private:
+	typedef struct Archetype {
+		unsigned mask;
+		size_t count;
+		std::vector<EntityChunk> chunks;
+	} Archetype;
+
+	typedef struct EntityRecord {
+		unsigned archetype, chunk, row;
+		unsigned generation;
+		bool isAlive;
+	} EntityRecord;
+
+	std::vector<Archetype> archetypes;
+	std::unordered_map<unsigned, unsigned> archetypeByMask;
+	std::vector<EntityRecord> records;
+	std::vector<unsigned> freeRecords;
+	size_t entityCount = 0;
+	///<summary>
+	///Chunks selected for parallel update. Kept between calls to avoid allocations
+	///</summary>
+	std::vector<EntityChunk*> chunkList;
+
+	unsigned GetArchetype(unsigned mask) {
+		auto found = archetypeByMask.find(mask);
+		if (found != archetypeByMask.end()) { return found->second; }
+
+		Archetype archetype;
+		archetype.mask = mask;
+		archetype.count = 0;
+		archetypes.push_back(archetype);
+		archetypeByMask[mask] = (unsigned)archetypes.size() - 1;
+		return (unsigned)archetypes.size() - 1;
+	}
+	///<summary>
+	///Appends row with default components to archetype and points record to it
+	///</summary>
+	void AppendRow(unsigned archetypeIndex, unsigned recordIndex) {
+		Archetype& archetype = archetypes[archetypeIndex];
+		if (archetype.chunks.empty() || archetype.chunks.back().count == EntityChunkCapacity) { archetype.chunks.push_back(EntityChunk(archetype.mask)); }
+
+		EntityChunk& chunk = archetype.chunks.back();
+		const size_t row = chunk.count++;
+		chunk.entities[row] = Entity(recordIndex, records[recordIndex].generation);
+		if (chunk.Has(transform)) { chunk.positions[row] = Vector3(); chunk.rotations[row] = Quaternion(); chunk.scales[row] = Vector3(1, 1, 1); }
+		if (chunk.Has(mesh)) { chunk.meshes[row] = MeshHandle(); }
+		if (chunk.Has(material)) { chunk.materials[row] = Material(); }
+		if (chunk.Has(color)) { chunk.colors[row] = Color(255, 255, 255); }
+		if (chunk.Has(velocity)) { chunk.velocities[row] = Velocity(); }
+		++archetype.count;
+
+		EntityRecord& record = records[recordIndex];
+		record.archetype = archetypeIndex;
+		record.chunk = (unsigned)archetype.chunks.size() - 1;
+		record.row = (unsigned)row;
+	}
+	///<summary>
+	///Copies components present in both chunks
+	///</summary>
+	static void CopyRow(const EntityChunk& from, size_t fromRow, EntityChunk& to, size_t toRow) {
+		const unsigned shared = from.mask & to.mask;
+		if (shared & transform) { to.positions[toRow] = from.positions[fromRow]; to.rotations[toRow] = from.rotations[fromRow]; to.scales[toRow] = from.scales[fromRow]; }
+		if (shared & mesh) { to.meshes[toRow] = from.meshes[fromRow]; }
+		if (shared & material) { to.materials[toRow] = from.materials[fromRow]; }
+		if (shared & color) { to.colors[toRow] = from.colors[fromRow]; }
+		if (shared & velocity) { to.velocities[toRow] = from.velocities[fromRow]; }
+	}
+	///<summary>
+	///Removes row by moving last row of archetype into it, so chunks stay dense
+	///</summary>
+	void RemoveRow(unsigned archetypeIndex, unsigned chunkIndex, unsigned row) {
+		Archetype& archetype = archetypes[archetypeIndex];
+		EntityChunk& last = archetype.chunks.back();
+		const size_t lastRow = last.count - 1;
+
+		if (&last != &archetype.chunks[chunkIndex] || lastRow != row) {
+			EntityChunk& chunk = archetype.chunks[chunkIndex];
+			CopyRow(last, lastRow, chunk, row);
+			chunk.entities[row] = last.entities[lastRow];
+
+			EntityRecord& moved = records[chunk.entities[row].index];
+			moved.chunk = chunkIndex;
+			moved.row = row;
+		}
+		--last.count;
+		--archetype.count;
+		if (last.count == 0) { archetype.chunks.pop_back(); }
+	}
+	void MoveToArchetype(Entity entity, unsigned newMask) {
+		EntityRecord& record = records[entity.index];
+		const unsigned oldArchetype = record.archetype, oldChunk = record.chunk, oldRow = record.row;
+		if (archetypes[oldArchetype].mask == newMask) { return; }
+
+		const unsigned newArchetype = GetArchetype(newMask);
+		AppendRow(newArchetype, entity.index);
+		const EntityRecord& moved = records[entity.index];
+		CopyRow(archetypes[oldArchetype].chunks[oldChunk], oldRow, archetypes[newArchetype].chunks[moved.chunk], moved.row);
+		RemoveRow(oldArchetype, oldChunk, oldRow);
+	}
+	EntityChunk* Find(Entity entity, unsigned components, size_t& row) {
+		if (!IsAlive(entity)) { return nullptr; }
+		const EntityRecord& record = records[entity.index];
+		EntityChunk& chunk = archetypes[record.archetype].chunks[record.chunk];
+		if (!chunk.Has(components)) { return nullptr; }
+		row = record.row;
+		return &chunk;
+	}
+
+public:
+	///<summary>
+	///Creates entity with given set of components (combination of World::Component). Components get default values
+	///</summary>
+	Entity Create(unsigned components) {
+		unsigned index;
+		if (freeRecords.empty()) {
+			index = (unsigned)records.size();
+			EntityRecord record = { 0, 0, 0, 0, false };
+			records.push_back(record);
+		}
+		else { index = freeRecords.back(); freeRecords.pop_back(); }
+
+		records[index].isAlive = true;
+		AppendRow(GetArchetype(components), index);
+		++entityCount;
+		return Entity(index, records[index].generation);
+	}
+	void Destroy(Entity entity) {
+		if (!IsAlive(entity)) { return; }
+
+		EntityRecord& record = records[entity.index];
+		RemoveRow(record.archetype, record.chunk, record.row);
+		record.isAlive = false;
+		++record.generation;
+		freeRecords.push_back(entity.index);
+		--entityCount;
+	}
+	bool IsAlive(Entity entity) const { return entity.index < records.size() && records[entity.index].isAlive && records[entity.index].generation == entity.generation; }
+	size_t GetEntityCount(void) const { return entityCount; }
+	///<summary>
+	///Reserves room for given amount of entities, so creating them does not reallocate entity records
+	///</summary>
+	void Reserve(size_t count) { records.reserve(count); }
+
+	///<summary>
+	///Adds components to entity. Entity is moved to another archetype, existing component values are kept
+	///</summary>
+	void AddComponents(Entity entity, unsigned components) { if (IsAlive(entity)) { MoveToArchetype(entity, archetypes[records[entity.index].archetype].mask | components); } }
+	void RemoveComponents(Entity entity, unsigned components) { if (IsAlive(entity)) { MoveToArchetype(entity, archetypes[records[entity.index].archetype].mask & ~components); } }
+	bool HasComponents(Entity entity, unsigned components) const { return IsAlive(entity) && (archetypes[records[entity.index].archetype].mask & components) == components; }
+
+	///<summary>
+	///Sets components of entity. Returns false if entity is not alive or has no such component
+	///</summary>
+	bool SetTransform(Entity entity, const Transform& value) {
+		size_t row; EntityChunk* chunk = Find(entity, transform, row);
+		if (!chunk) { return false; }
+		chunk->positions[row] = value.position; chunk->rotations[row] = value.rotation; chunk->scales[row] = value.scale;
+		return true;
+	}
+	bool SetMesh(Entity entity, MeshHandle value) { size_t row; EntityChunk* chunk = Find(entity, mesh, row); if (chunk) { chunk->meshes[row] = value; } return chunk != nullptr; }
+	bool SetMaterial(Entity entity, const Material& value) { size_t row; EntityChunk* chunk = Find(entity, material, row); if (chunk) { chunk->materials[row] = value; } return chunk != nullptr; }
+	bool SetColor(Entity entity, const Color& value) { size_t row; EntityChunk* chunk = Find(entity, color, row); if (chunk) { chunk->colors[row] = value; } return chunk != nullptr; }
+	bool SetVelocity(Entity entity, const Velocity& value) { size_t row; EntityChunk* chunk = Find(entity, velocity, row); if (chunk) { chunk->velocities[row] = value; } return chunk != nullptr; }
+	///<summary>
+	///Returns transform of entity or default transform, if it has none
+	///</summary>
+	Transform GetTransform(Entity entity) {
+		size_t row; EntityChunk* chunk = Find(entity, transform, row);
+		return chunk ? Transform(chunk->positions[row], chunk->rotations[row], chunk->scales[row]) : Transform();
+	}
+
+	///<summary>
+	///Calls function(EntityChunk&) for every chunk, that has all given components
+	///</summary>
+	template <typename Function>
+	void ForEachChunk(unsigned components, Function function) {
+		for (size_t a = 0; a < archetypes.size(); ++a) {
+			if ((archetypes[a].mask & components) != components) { continue; }
+			for (size_t c = 0; c < archetypes[a].chunks.size(); ++c) { function(archetypes[a].chunks[c]); }
+		}
+	}
+	template <typename Function>
+	void ForEachChunk(unsigned components, Function function) const {
+		for (size_t a = 0; a < archetypes.size(); ++a) {
+			if ((archetypes[a].mask & components) != components) { continue; }
+			for (size_t c = 0; c < archetypes[a].chunks.size(); ++c) { function(archetypes[a].chunks[c]); }
+		}
+	}
+	///<summary>
+	///Calls function(EntityChunk&) for every chunk, that has all given components, on job system workers. Function must only touch its own chunk.
+	///Entities must not be created, destroyed or change components meanwhile
+	///</summary>
+	template <typename Function>
+	void ParallelForEachChunk(unsigned components, Function function) {
+		std::vector<EntityChunk*>& chunks = chunkList;
+		chunks.clear();
+		ForEachChunk(components, [&chunks](EntityChunk& chunk) { chunks.push_back(&chunk); });
+
+		JobSystem::Get().ParallelFor(chunks.size(), [&chunks, &function](size_t i) { function(*chunks[i]); });
+	}
+
+	///<summary>
+	///Moves and rotates every entity with transform and velocity by given time step. Chunks are updated in parallel.
+	///Returns true if any entity has nonzero velocity, so the scene changed
+	///</summary>
+	bool ApplyVelocities(float deltaTime) {
+		PROFILE_SCOPE("World::ApplyVelocities");
+		std::atomic<bool> isMoved(false);
+		ParallelForEachChunk(transform | velocity, [deltaTime, &isMoved](EntityChunk& chunk) {
+			bool isChunkMoved = false;
+			for (size_t i = 0; i < chunk.count; ++i) {
+				const Velocity& v = chunk.velocities[i];
+				if (v.linear.x != 0 || v.linear.y != 0 || v.linear.z != 0) { isChunkMoved = true; }
+				chunk.positions[i] = chunk.positions[i] + Vector3(v.linear) * deltaTime;
+
+				const Vector3 angle = Vector3(v.angular) * deltaTime;
+				if (angle.x == 0 && angle.y == 0 && angle.z == 0) { continue; }
+				isChunkMoved = true;
+
+				Quaternion q = Quaternion::EulerAngles(angle.x, angle.y, angle.z) * chunk.rotations[i];
+				const float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+				chunk.rotations[i] = Quaternion(q.x / length, q.y / length, q.z / length, q.w / length);
+			}
+			if (isChunkMoved) { isMoved.store(true, std::memory_order_relaxed); }
+		});
+		return isMoved.load();
+	}
+};
+
+inline EntityChunk::EntityChunk(unsigned componentMask) {
+	mask = componentMask;
+	count = 0;
+	entities.resize(EntityChunkCapacity);
+	if (mask & World::transform) { positions.resize(EntityChunkCapacity); rotations.resize(EntityChunkCapacity); scales.resize(EntityChunkCapacity); }
+	if (mask & World::mesh) { meshes.resize(EntityChunkCapacity); }
+	if (mask & World::material) { materials.resize(EntityChunkCapacity); }
+	if (mask & World::color) { colors.resize(EntityChunkCapacity); }
+	if (mask & World::velocity) { velocities.resize(EntityChunkCapacity); }
+}
+
+#define RendererJobGrain	4096	// vertices, faces or instances per job of CPU render paths; smaller work stays on the calling thread
+
 class Renderer {
 public:
 	Camera camera;
 
 private:
+	GLExtensions gl;
+	///<summary>
+	///Mesh cache. Slot 0 is reserved for invalid handle
+	///</summary>
+	std::vector<GpuMesh> meshCache = std::vector<GpuMesh>(1);
+	std::vector<unsigned> freeMeshSlots;
+	///<summary>
+	///Scratch memory for transient transform and color data. Reset in BeginFrame()
+	///</summary>
+	FrameArena frameArena;
+	///<summary>
+	///Per-instance attributes of instanced draw
+	///</summary>
+	typedef struct InstanceData {
+		float position[3];
+		float rotation[4];
+		float scale[3];
+		unsigned char color[4];
+	} InstanceData;
+	///<summary>
+	///Uniform locations of a material shading program
+	///</summary>
+	typedef struct MaterialUniforms {
+		GLint metallic, roughness, faceOrientFactor, metalColor, faceFrontColor, faceBackColor;
+		GLint modelPosition, modelRotation, modelScale;
+
+		///<summary>
+		///Finds uniform locations and attaches Camera block of given program to CameraBlockBinding
+		///</summary>
+		void Load(const GLExtensions& gl, GLuint program) {
+			metallic = gl.glGetUniformLocation(program, "metallic");
+			roughness = gl.glGetUniformLocation(program, "roughness");
+			faceOrientFactor = gl.glGetUniformLocation(program, "faceOrientFactor");
+			metalColor = gl.glGetUniformLocation(program, "metalColor");
+			faceFrontColor = gl.glGetUniformLocation(program, "faceFrontColor");
+			faceBackColor = gl.glGetUniformLocation(program, "faceBackColor");
+			modelPosition = gl.glGetUniformLocation(program, "modelPosition");
+			modelRotation = gl.glGetUniformLocation(program, "modelRotation");
+			modelScale = gl.glGetUniformLocation(program, "modelScale");
+
+			const GLuint cameraBlock = gl.glGetUniformBlockIndex(program, "Camera");
+			if (cameraBlock != GL_INVALID_INDEX) { gl.glUniformBlockBinding(program, cameraBlock, CameraBlockBinding); }
+		}
+	} MaterialUniforms;
+
+	///<summary>
+	///GLSL programs of every Material::Shader, indexed by it. Invalid if OpenGL 3.3 is not available
+	///</summary>
+	ShaderProgram meshPrograms[4], instancedPrograms[4];
+	MaterialUniforms meshUniforms[4], instancedUniforms[4];
+	GLuint cameraBuffer = 0, instanceBuffer = 0;
+	bool isGpuShadingEnabled = true;
+	///<summary>
+	///GPU pass timing. Invalid without timer queries, then scopes cost nothing
+	///</summary>
+	GpuProfiler gpuProfiler;
+	unsigned gpuFrameScope = GpuProfiler::InvalidScope, gpuMeshScope = GpuProfiler::InvalidScope;
+	///<summary>
+	///Level of detail settings. Level is switched when its geometric error covers more than lodPixelError pixels
+	///</summary>
+	float lodPixelError = 1.0f, lodHysteresis = 0.25f;
+	float viewportHeight = 1;
+	bool isCullingEnabled = true;
+	size_t culledMeshes = 0;
+
 	///<summary>
 	///Returns value clapmed between min and max
 	///</summary>
@@ -137,8 +636,17 @@ public:
 		glColor3ub(color.r, color.g, color.b);
 		glVertex3f(vertex.position.x, vertex.position.y, vertex.position.z);
 	}
+	static void SendVertex(const Vector3& position, const Color& color) {
+		glColor3ub(color.r, color.g, color.b);
+		glVertex3f(position.x, position.y, position.z);
+	}
 
 	void init(void) {
+		PROFILE_SCOPE("Renderer::init");
+		gl.Load();
+		if (gl.HasUniformBlocks() && !cameraBuffer) { CreateMaterialPrograms(); }
+		gpuProfiler.Create(gl);
+
 		glMatrixMode(GL_PROJECTION);
 		glLoadIdentity();
 		camera.SetAvailable();
@@ -152,6 +660,9 @@ public:
 	///Sends points to render with given color
 	///</summary>
 	void RenderPoints(const std::vector<Vector3> &points, const Color& color) {
+		PROFILE_SCOPE("Renderer::RenderPoints");
+		EndMeshPass();
+		GPU_PROFILE_SCOPE(gpuProfiler, "Points");
 		size_t pSize = points.size();
 		glBegin(GL_POINTS);
 		glColor3ub(color.r, color.g, color.b);
@@ -179,45 +690,266 @@ public:
 		glEnd();
 	}
 private:
+	///<summary>
+	///Returns false if object space sphere placed with given transform is outside camera view. Counts culled meshes
+	///</summary>
+	bool IsVisible(const BoundingSphere& bounds, const Transform& transform) {
+		if (!isCullingEnabled || IsInFrustum(camera.GetFrustum(), bounds, transform)) { return true; }
+		++culledMeshes;
+		return false;
+	}
+	///<summary>
+	///Returns true if transformed bounds intersect frustum. Changes no state, so it is safe to call from jobs
+	///</summary>
+	static bool IsInFrustum(const Frustum& frustum, const BoundingSphere& bounds, const Transform& transform) {
+		const Vector3 center = Vector3::MultiplyPairwise(bounds.center, transform.scale).Rotation(transform.rotation) + transform.position;
+		const float maxScale = fmaxf(fabsf(transform.scale.x), fmaxf(fabsf(transform.scale.y), fabsf(transform.scale.z)));
+		return frustum.Intersects(BoundingSphere(center, bounds.radius * maxScale));
+	}
+	///<summary>
+	///Compiles mesh and instanced programs of every material, creates camera uniform buffer
+	///</summary>
+	void CreateMaterialPrograms(void) {
+		for (int shader = 0; shader < 4; ++shader) {
+			const std::string meshSource = MaterialVertexSource(shader, MeshVertexShader), fragmentSource = MaterialFragmentSource(shader);
+			if (meshPrograms[shader].Create(gl, meshSource.c_str(), fragmentSource.c_str(), MeshAttributes, 3)) { meshUniforms[shader].Load(gl, meshPrograms[shader].GetId()); }
+
+			const std::string instancedSource = MaterialVertexSource(shader, InstancedVertexShader);
+			if (gl.HasInstancing() && instancedPrograms[shader].Create(gl, instancedSource.c_str(), fragmentSource.c_str(), InstancedAttributes, 6)) { instancedUniforms[shader].Load(gl, instancedPrograms[shader].GetId()); }
+		}
+		gl.glGenBuffers(1, &cameraBuffer);
+		gl.glBindBuffer(GL_UNIFORM_BUFFER, cameraBuffer);
+		gl.glBufferData(GL_UNIFORM_BUFFER, 24 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+		gl.glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		if (gl.HasInstancing()) { gl.glGenBuffers(1, &instanceBuffer); }
+	}
+	///<summary>
+	///Fills Camera uniform block from fixed function matrices set in BeginFrame()
+	///</summary>
+	void UpdateCameraBlock(void) {
+		if (!cameraBuffer) { return; }
+
+		Matrix4x4 projection, view;
+		glGetFloatv(GL_PROJECTION_MATRIX, projection.m);
+		glGetFloatv(GL_MODELVIEW_MATRIX, view.m);
+		const Vector3 cameraNormal = camera.Normal(), cameraPosition = camera.GetCameraPosition();
+
+		float block[24]; // std140: mat4 viewProjection, vec4 cameraNormal, vec4 cameraPosition
+		memcpy(block, (projection * view).m, 16 * sizeof(float));
+		block[16] = cameraNormal.x; block[17] = cameraNormal.y; block[18] = cameraNormal.z; block[19] = 0;
+		block[20] = cameraPosition.x; block[21] = cameraPosition.y; block[22] = cameraPosition.z; block[23] = camera.GetFarClip();
+
+		gl.glBindBuffer(GL_UNIFORM_BUFFER, cameraBuffer);
+		gl.glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), block);
+		gl.glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		gl.glBindBufferBase(GL_UNIFORM_BUFFER, CameraBlockBinding, cameraBuffer);
+	}
+	///<summary>
+	///Sets material uniforms of current program
+	///</summary>
+	void SetMaterialUniforms(const MaterialUniforms& uniforms, const Material& material) {
+		gl.glUniform1f(uniforms.metallic, material.metallic);
+		gl.glUniform1f(uniforms.roughness, material.roughness);
+		gl.glUniform1f(uniforms.faceOrientFactor, material.faceorientfactor);
+		gl.glUniform3f(uniforms.metalColor, material.metal.r, material.metal.g, material.metal.b);
+		gl.glUniform3f(uniforms.faceFrontColor, material.facefront.r, material.facefront.g, material.facefront.b);
+		gl.glUniform3f(uniforms.faceBackColor, material.faceback.r, material.faceback.g, material.faceback.b);
+	}
+	///<summary>
+	///Calls function(begin, end) for ranges of RendererJobGrain items of [0; count) in parallel on the shared job system.
+	///Function must not use frameArena or OpenGL, allocate its output before the call
+	///</summary>
+	template <typename Function>
+	static void ParallelForRanges(size_t count, Function function) {
+		const size_t rangeSz = (count + RendererJobGrain - 1) / RendererJobGrain;
+		JobSystem::Get().ParallelFor(rangeSz, [count, &function](size_t range) {
+			const size_t begin = range * RendererJobGrain;
+			function(begin, begin + RendererJobGrain < count ? begin + RendererJobGrain : count);
+		});
+	}
+	///<summary>
+	///Multiplies current OpenGL matrix by translation, rotation and scale
+	///</summary>
+	static void MultiplyTransform(const Transform& transform) {
+		glMultMatrixf(Matrix4x4::FromTransform(transform).m);
+	}
+	///<summary>
+	///Writes per-face colors of given material to provoking vertices of uploaded mesh. Materials lit per vertex get a color per face corner instead,
+	///colors then holds 4 bytes per index. Camera is moved to object space, so vertices stay untransformed
+	///</summary>
+	void ShadeFaces(const GpuMesh& gpuMesh, unsigned char* colors, const Transform& transform, const Color& color, const Material& material) {
+		const Quaternion& rotation = transform.rotation;
+		const Quaternion inverse(-rotation.x, -rotation.y, -rotation.z, rotation.w);
+		const Vector3 cameraNormal = camera.Normal().Rotation(inverse);
+		const Vector3 cameraPosition = (camera.GetCameraPosition() - Vector3(transform.position)).Rotation(inverse);
+
+		//Batched mesh is shaded range by range, each with constants of its own color
+		const bool hasRanges = !gpuMesh.colorRanges.empty();
+		const size_t faceSz = gpuMesh.faceNormals.size();
+		const size_t rangeSz = hasRanges ? gpuMesh.colorRanges.size() : 1;
+
+		for (size_t range = 0; range < rangeSz; ++range) {
+			const size_t first = hasRanges ? gpuMesh.colorRanges[range].firstFace : 0;
+			const size_t end = hasRanges && range + 1 < rangeSz ? gpuMesh.colorRanges[range + 1].firstFace : faceSz;
+			const ShadingConstants constants(material, hasRanges ? gpuMesh.colorRanges[range].color : color, cameraNormal, cameraPosition, camera.GetFarClip());
+
+			switch (material.shader) {
+			case Material::diffuse: ShadeFaces<Material::diffuse>(gpuMesh, colors, first, end, transform.scale, constants); break;
+			case Material::realistic: ShadeFaces<Material::realistic>(gpuMesh, colors, first, end, transform.scale, constants); break;
+			case Material::faceorient: ShadeFaces<Material::faceorient>(gpuMesh, colors, first, end, transform.scale, constants); break;
+			default: ShadeFaces<Material::unlit>(gpuMesh, colors, first, end, transform.scale, constants); break;
+			}
+		}
+	}
+	template<Material::Shader shader>
+	void ShadeFaces(const GpuMesh& gpuMesh, unsigned char* colors, size_t firstFace, size_t endFace, const Vector3& scale, const ShadingConstants& constants) {
+		typedef MaterialKernel<shader> Kernel;
+		//Scaled mesh: normals are multiplied by inverse scale, positions by scale
+		const bool isScaled = scale.x != 1 || scale.y != 1 || scale.z != 1;
+		const Vector3 inverseScale(1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z);
+
+		const size_t faceSz = endFace - firstFace;
+		const unsigned* indices = gpuMesh.indices.data() + firstFace * 3;
+		const Vector3* faceNormals = gpuMesh.faceNormals.data() + firstFace;
+		const float* positions = gpuMesh.positions.data();
+		const size_t colorSz = Kernel::isPerVertex ? faceSz * 3 : faceSz; // one color per face, or per face corner
+
+		//Base colors and light factors are gathered per face, color math then runs over whole arrays
+		float* r = frameArena.Allocate<float>(colorSz);
+		float* g = frameArena.Allocate<float>(colorSz);
+		float* b = frameArena.Allocate<float>(colorSz);
+		float* factors = frameArena.Allocate<float>(colorSz);
+		unsigned char* faceColors = Kernel::isPerVertex ? colors + firstFace * 3 * 4 : frameArena.Allocate<unsigned char>(faceSz * 4);
+
+		//Every face has provoking vertex, or corners, of its own, so ranges write disjoint colors
+		ParallelForRanges(faceSz, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				float normalAngle = 0;
+				if (Kernel::isLit) { normalAngle = constants.Angle(isScaled ? Vector3::MultiplyPairwise(faceNormals[i], inverseScale).Normal() : faceNormals[i]); }
+				const Color& base = Kernel::Base(constants, normalAngle);
+
+				if (Kernel::isPerVertex) {
+					for (size_t k = i * 3; k < i * 3 + 3; ++k) {
+						const unsigned vertex = indices[k];
+						r[k] = base.r; g[k] = base.g; b[k] = base.b;
+						factors[k] = Kernel::Factor(constants, normalAngle, Vector3::MultiplyPairwise(Vector3(positions[vertex * 3], positions[vertex * 3 + 1], positions[vertex * 3 + 2]), scale));
+					}
+				}
+				else {
+					r[i] = base.r; g[i] = base.g; b[i] = base.b;
+					factors[i] = Kernel::Factor(constants, normalAngle, Vector3());
+				}
+			}
+			const size_t first = Kernel::isPerVertex ? begin * 3 : begin;
+			const size_t last = Kernel::isPerVertex ? end * 3 : end;
+			ColorKernels::Scale(r + first, g + first, b + first, factors + first, r + first, g + first, b + first, last - first);
+			ColorKernels::PackRGBA8(r + first, g + first, b + first, faceColors + first * 4, last - first);
+
+			if (!Kernel::isPerVertex) {
+				for (size_t i = begin; i < end; ++i) { memcpy(&colors[(size_t)indices[i * 3 + 2] * 4], &faceColors[i * 4], 4); }
+			}
+		});
+	}
+	///<summary>
+	///Returns true if given material shades every vertex on its own, so faces can not be drawn flat with provoking vertex color
+	///</summary>
+	static bool IsPerVertex(Material::Shader shader) {
+		switch (shader) {
+		case Material::diffuse: return MaterialKernel<Material::diffuse>::isPerVertex;
+		case Material::realistic: return MaterialKernel<Material::realistic>::isPerVertex;
+		case Material::faceorient: return MaterialKernel<Material::faceorient>::isPerVertex;
+		default: return MaterialKernel<Material::unlit>::isPerVertex;
+		}
+	}
+	///<summary>
+	///Renders all triangles of transformed mesh with given world space face normals (unused by unlit shader)
+	///</summary>
+	template<Material::Shader shader>
+	void RenderTriangles(const IndexList& triangles, const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz, const ShadingConstants& constants) {
+		typedef MaterialKernel<shader> Kernel;
+		const size_t triaSz = triangles.size() / 3;
+		const size_t colorSz = Kernel::isPerVertex ? triaSz * 3 : triaSz; // one color per face, or per face corner
+
+		float* r = frameArena.Allocate<float>(colorSz);
+		float* g = frameArena.Allocate<float>(colorSz);
+		float* b = frameArena.Allocate<float>(colorSz);
+		float* factors = frameArena.Allocate<float>(colorSz);
+		unsigned char* colors = frameArena.Allocate<unsigned char>(colorSz * 4);
+
+		//Colors are computed in parallel, immediate mode submission stays on the OpenGL thread
+		ParallelForRanges(triaSz, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const float normalAngle = Kernel::isLit ? constants.Angle(Vector3(nx[i], ny[i], nz[i])) : 0;
+				const Color& base = Kernel::Base(constants, normalAngle);
+
+				if (Kernel::isPerVertex) {
+					for (size_t k = i * 3; k < i * 3 + 3; ++k) {
+						const unsigned vertex = triangles[k];
+						r[k] = base.r; g[k] = base.g; b[k] = base.b;
+						factors[k] = Kernel::Factor(constants, normalAngle, Vector3(x[vertex], y[vertex], z[vertex]));
+					}
+				}
+				else {
+					r[i] = base.r; g[i] = base.g; b[i] = base.b;
+					factors[i] = Kernel::Factor(constants, normalAngle, Vector3());
+				}
+			}
+			const size_t first = Kernel::isPerVertex ? begin * 3 : begin;
+			const size_t last = Kernel::isPerVertex ? end * 3 : end;
+			ColorKernels::Scale(r + first, g + first, b + first, factors + first, r + first, g + first, b + first, last - first);
+			ColorKernels::PackRGBA8(r + first, g + first, b + first, colors + first * 4, last - first);
+		});
+
+		glBegin(GL_TRIANGLES);
+		for (size_t k = 0; k < triaSz * 3; ++k) {
+			const unsigned vertex = triangles[k];
+			glColor3ubv(&colors[(Kernel::isPerVertex ? k : k / 3) * 4]);
+			glVertex3f(x[vertex], y[vertex], z[vertex]);
+		}
+		glEnd();
+	}
 	///<summary>
 	///Sends triangle to render with given material. Prefer this function. Must be called only in glBegin(GL_TRIANGLES) event
 	///</summary>
-	void RenderTriangleNoCall(const Triangle& triangle, const Material& material) {
+	void RenderTriangleNoCall(const Vector3& a, const Vector3& b, const Vector3& c, const Color& colorA, const Color& colorB, const Color& colorC, const Material& material) {
 		float normalAngle;
 		bool isBackface;
 
 		switch (material.shader) {
 		case Material::unlit:
-			SendVertex(triangle.a);
-			SendVertex(triangle.b);
-			SendVertex(triangle.c);
+			SendVertex(a, colorA);
+			SendVertex(b, colorB);
+			SendVertex(c, colorC);
 			break;
 		case Material::diffuse:
-			normalAngle = diffusePoint(Vector3::Angle(camera.Normal(), triangle.Normal()), material.roughness);
+			normalAngle = diffusePoint(Vector3::Angle(camera.Normal(), Triangle::Normal(a, b, c)), material.roughness);
 
-			SendVertex(triangle.a, Color::Lerp(triangle.a.color, material.metal, material.metallic) * normalAngle);
-			SendVertex(triangle.b, Color::Lerp(triangle.b.color, material.metal, material.metallic) * normalAngle);
-			SendVertex(triangle.c, Color::Lerp(triangle.c.color, material.metal, material.metallic) * normalAngle);
+			SendVertex(a, Color::Lerp(colorA, material.metal, material.metallic) * normalAngle);
+			SendVertex(b, Color::Lerp(colorB, material.metal, material.metallic) * normalAngle);
+			SendVertex(c, Color::Lerp(colorC, material.metal, material.metallic) * normalAngle);
 			break;
 		case Material::realistic:
-			normalAngle = Vector3::Angle(camera.Normal(), triangle.Normal());
+			normalAngle = Vector3::Angle(camera.Normal(), Triangle::Normal(a, b, c));
 
-			SendVertex(triangle.a, Color::Lerp(triangle.a.color, material.metal, material.metallic) * realisticPoint(normalAngle, Vector3::Distance(camera.GetCameraPosition(), triangle.a.position), material.roughness));
-			SendVertex(triangle.b, Color::Lerp(triangle.b.color, material.metal, material.metallic) * realisticPoint(normalAngle, Vector3::Distance(camera.GetCameraPosition(), triangle.b.position), material.roughness));
-			SendVertex(triangle.c, Color::Lerp(triangle.c.color, material.metal, material.metallic) * realisticPoint(normalAngle, Vector3::Distance(camera.GetCameraPosition(), triangle.c.position), material.roughness));
+			SendVertex(a, Color::Lerp(colorA, material.metal, material.metallic) * realisticPoint(normalAngle, Vector3::Distance(camera.GetCameraPosition(), a), material.roughness));
+			SendVertex(b, Color::Lerp(colorB, material.metal, material.metallic) * realisticPoint(normalAngle, Vector3::Distance(camera.GetCameraPosition(), b), material.roughness));
+			SendVertex(c, Color::Lerp(colorC, material.metal, material.metallic) * realisticPoint(normalAngle, Vector3::Distance(camera.GetCameraPosition(), c), material.roughness));
 			break;
 		case Material::faceorient:
-			normalAngle = Vector3::Angle(camera.Normal(), triangle.Normal());
+			normalAngle = Vector3::Angle(camera.Normal(), Triangle::Normal(a, b, c));
 			isBackface = normalAngle < 0;
 			normalAngle = diffusePoint(normalAngle, material.roughness);
 			
-			SendVertex(triangle.a, Color::Lerp(triangle.a.color, isBackface ? material.facefront : material.faceback, material.faceorientfactor) * normalAngle);
-			SendVertex(triangle.b, Color::Lerp(triangle.b.color, isBackface ? material.facefront : material.faceback, material.faceorientfactor) * normalAngle);
-			SendVertex(triangle.c, Color::Lerp(triangle.c.color, isBackface ? material.facefront : material.faceback, material.faceorientfactor) * normalAngle);
+			SendVertex(a, Color::Lerp(colorA, isBackface ? material.facefront : material.faceback, material.faceorientfactor) * normalAngle);
+			SendVertex(b, Color::Lerp(colorB, isBackface ? material.facefront : material.faceback, material.faceorientfactor) * normalAngle);
+			SendVertex(c, Color::Lerp(colorC, isBackface ? material.facefront : material.faceback, material.faceorientfactor) * normalAngle);
 			break;
 		default: break;
 		}
 	}
+	void RenderTriangleNoCall(const Triangle& triangle, const Material& material) {
+		RenderTriangleNoCall(triangle.a.position, triangle.b.position, triangle.c.position, triangle.a.color, triangle.b.color, triangle.c.color, material);
+	}
 public:
 	///<summary>
 	///Sends triangle to render with given material
@@ -231,22 +963,526 @@ public:
 	///Renders mesh with given parameters
 	///</summary>
 	void RenderMesh(const Mesh& mesh, const Vector3& position, const Quaternion& rotation, const Color& color, const Material& material) {
+		PROFILE_SCOPE("Renderer::RenderMesh (Mesh)");
+		BeginMeshPass();
+		if (!IsVisible(mesh.GetBoundingSphere(), Transform(position, rotation))) { return; }
+
 		const size_t vertSz = mesh.vertices.size();
-		const size_t triaSz = mesh.triangles.size() + 3;
 
-		std::vector<Vector3> modifiedMesh;
+		float* mx = frameArena.Allocate<float>(vertSz);
+		float* my = frameArena.Allocate<float>(vertSz);
+		float* mz = frameArena.Allocate<float>(vertSz);
 		
-		glBegin(GL_TRIANGLES);
-		for (size_t i = 0; i < vertSz; ++i) { modifiedMesh.push_back(mesh.vertices[i].Rotation(rotation) + position); }
-		for (size_t i = 3; i < triaSz; i += 3) {
-			RenderTriangleNoCall(Triangle(modifiedMesh[mesh.triangles[i - 3]], modifiedMesh[mesh.triangles[i - 2]], modifiedMesh[mesh.triangles[i - 1]], color), material);
+		const float* vx = mesh.vertices.GetX(); const float* vy = mesh.vertices.GetY(); const float* vz = mesh.vertices.GetZ();
+		const Matrix4x4 matrix = Matrix4x4::TRS(position, rotation, Vector3(1, 1, 1));
+		ParallelForRanges(vertSz, [&](size_t begin, size_t end) {
+			VertexKernels::Transform(vx + begin, vy + begin, vz + begin, mx + begin, my + begin, mz + begin, end - begin, matrix);
+		});
+
+		//Lit shaders take cached object space face normals, only rotation is left per frame
+		float* nx = nullptr; float* ny = nullptr; float* nz = nullptr;
+		if (material.shader != Material::unlit) {
+			const VertexStream& faceNormals = mesh.GetFaceNormals();
+			nx = frameArena.Allocate<float>(faceNormals.size());
+			ny = frameArena.Allocate<float>(faceNormals.size());
+			nz = frameArena.Allocate<float>(faceNormals.size());
+			const float* fx = faceNormals.GetX(); const float* fy = faceNormals.GetY(); const float* fz = faceNormals.GetZ();
+			ParallelForRanges(faceNormals.size(), [&](size_t begin, size_t end) {
+				VertexKernels::Rotate(fx + begin, fy + begin, fz + begin, nx + begin, ny + begin, nz + begin, end - begin, rotation);
+			});
 		}
-		glEnd();
+
+		const ShadingConstants constants(material, color, camera.Normal(), camera.GetCameraPosition(), camera.GetFarClip());
+		switch (material.shader) {
+		case Material::diffuse: RenderTriangles<Material::diffuse>(mesh.triangles, mx, my, mz, nx, ny, nz, constants); break;
+		case Material::realistic: RenderTriangles<Material::realistic>(mesh.triangles, mx, my, mz, nx, ny, nz, constants); break;
+		case Material::faceorient: RenderTriangles<Material::faceorient>(mesh.triangles, mx, my, mz, nx, ny, nz, constants); break;
+		default: RenderTriangles<Material::unlit>(mesh.triangles, mx, my, mz, nx, ny, nz, constants); break;
+		}
+	}
+	///<summary>
+	///Uploads mesh into vertex and index buffers once. Render it with RenderMesh(MeshHandle, ...), free it with DestroyMesh().
+	///Returns invalid handle if any index is out of vertex range
+	///</summary>
+	MeshHandle UploadMesh(const Mesh& mesh) {
+		if (!mesh.HasValidIndices()) { return MeshHandle(); } // before MeshView computes normals with the indices
+		return UploadMesh(MeshView(mesh), std::vector<ColorRange>());
+	}
+	///<summary>
+	///Uploads viewed mesh, for example one mapped from MeshFile. Streams are read in place, cached normals and bounds of the view are used as they are.
+	///Returns invalid handle if any index is out of vertex range
+	///</summary>
+	MeshHandle UploadMesh(const MeshView& view) { return UploadMesh(view, std::vector<ColorRange>()); }
+	///<summary>
+	///Merges all entries of static batch into one mesh and uploads it. Render it with RenderBatch(), free it with DestroyBatch()
+	///</summary>
+	BatchHandle UploadBatch(const StaticBatch& batch) {
+		PROFILE_SCOPE("Renderer::UploadBatch");
+		Mesh mesh;
+		std::vector<ColorRange> colors;
+		batch.Build(mesh, colors);
+
+		BatchHandle handle;
+		if (!mesh.HasValidIndices()) { return handle; }
+		handle.mesh = UploadMesh(MeshView(mesh), colors);
+		handle.material = batch.material;
+		return handle;
+	}
+	///<summary>
+	///Renders whole static batch with one indexed draw call. Entries are already in world space
+	///</summary>
+	void RenderBatch(const BatchHandle& handle) {
+		PROFILE_SCOPE("Renderer::RenderBatch");
+		EndMeshPass();
+		GPU_PROFILE_SCOPE(gpuProfiler, "Batch");
+		DrawMesh(handle.mesh, Transform(), Color(255, 255, 255), handle.material);
+	}
+	///<summary>
+	///Frees buffers of uploaded static batch. Handle becomes invalid
+	///</summary>
+	void DestroyBatch(BatchHandle& handle) { DestroyMesh(handle.mesh); }
+private:
+	///<summary>
+	///Uploads mesh, optionally with face colors in ranges of consecutive faces
+	///</summary>
+	MeshHandle UploadMesh(const MeshView& mesh, const std::vector<ColorRange>& colorRanges) {
+		PROFILE_SCOPE("Renderer::UploadMesh");
+		if (!mesh.HasValidIndices()) { return MeshHandle(); }
+
+		unsigned id;
+		if (freeMeshSlots.empty()) { id = (unsigned)meshCache.size(); meshCache.push_back(GpuMesh()); }
+		else { id = freeMeshSlots.back(); freeMeshSlots.pop_back(); }
+
+		GpuMesh& gpuMesh = meshCache[id];
+		const size_t vertSz = mesh.vertexCount;
+		const size_t triaSz = mesh.GetTriangleCount();
+
+		gpuMesh.inUse = true;
+		gpuMesh.positions.clear();
+		gpuMesh.positions.reserve(vertSz * 3 + triaSz);
+		for (size_t i = 0; i < vertSz; ++i) {
+			gpuMesh.positions.push_back(mesh.x[i]);
+			gpuMesh.positions.push_back(mesh.y[i]);
+			gpuMesh.positions.push_back(mesh.z[i]);
+		}
+
+		//Rotate every triangle so its last vertex is used by no other triangle. Winding is preserved, vertex is duplicated only if all three are taken
+		std::vector<bool> isProvoking(vertSz, false);
+		gpuMesh.indices.resize(triaSz * 3);
+		gpuMesh.faceNormals.resize(triaSz);
+
+		for (size_t i = 0; i < triaSz; ++i) {
+			unsigned a = mesh.triangles[i * 3], b = mesh.triangles[i * 3 + 1], c = mesh.triangles[i * 3 + 2];
+
+			if (isProvoking[c]) {
+				if (!isProvoking[a]) { unsigned t = a; a = b; b = c; c = t; }
+				else if (!isProvoking[b]) { unsigned t = c; c = b; b = a; a = t; }
+				else {
+					gpuMesh.positions.push_back(mesh.x[c]);
+					gpuMesh.positions.push_back(mesh.y[c]);
+					gpuMesh.positions.push_back(mesh.z[c]);
+					c = (unsigned)isProvoking.size();
+					isProvoking.push_back(false);
+				}
+			}
+			isProvoking[c] = true;
+
+			gpuMesh.indices[i * 3] = a; gpuMesh.indices[i * 3 + 1] = b; gpuMesh.indices[i * 3 + 2] = c;
+			gpuMesh.faceNormals[i] = mesh.GetFaceNormal(i);
+		}
+
+		//Duplicates were appended at the end. Renumber vertices in order of first use, so vertex fetch stays sequential as after MeshOptimizer::OptimizeVertexFetch
+		if (isProvoking.size() > vertSz) {
+			const unsigned unused = ~0u;
+			std::vector<unsigned> remap(isProvoking.size(), unused);
+			std::vector<float> positions(gpuMesh.positions.size());
+			unsigned next = 0;
+			for (size_t k = 0; k < gpuMesh.indices.size(); ++k) {
+				unsigned& index = gpuMesh.indices[k];
+				if (remap[index] == unused) {
+					memcpy(&positions[(size_t)next * 3], &gpuMesh.positions[(size_t)index * 3], 3 * sizeof(float));
+					remap[index] = next++;
+				}
+				index = remap[index];
+			}
+			for (size_t v = 0; v < remap.size(); ++v) {
+				if (remap[v] == unused) { memcpy(&positions[(size_t)next++ * 3], &gpuMesh.positions[v * 3], 3 * sizeof(float)); } // unreferenced vertices go last
+			}
+			gpuMesh.positions.swap(positions);
+		}
+
+		gpuMesh.colorRanges = colorRanges;
+		gpuMesh.bounds = mesh.boundingSphere;
+		gpuMesh.vertexCount = (unsigned)isProvoking.size();
+		gpuMesh.indexCount = (GLsizei)gpuMesh.indices.size();
+
+		if (gl.HasBuffers()) {
+			GLuint buffers[4];
+			gl.glGenBuffers(4, buffers);
+			gpuMesh.vertexBuffer = buffers[0]; gpuMesh.indexBuffer = buffers[1]; gpuMesh.colorBuffer = buffers[2]; gpuMesh.normalBuffer = buffers[3];
+
+			std::vector<float> normals((size_t)gpuMesh.vertexCount * 3, 0.0f);
+			for (size_t i = 0; i < triaSz; ++i) {
+				const unsigned provoking = gpuMesh.indices[i * 3 + 2];
+				normals[provoking * 3] = gpuMesh.faceNormals[i].x; normals[provoking * 3 + 1] = gpuMesh.faceNormals[i].y; normals[provoking * 3 + 2] = gpuMesh.faceNormals[i].z;
+			}
+			gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.normalBuffer);
+			gl.glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(float), normals.data(), GL_STATIC_DRAW);
+
+			if (!colorRanges.empty()) {
+				std::vector<unsigned char> faceColors((size_t)gpuMesh.vertexCount * 4, 0);
+				for (size_t range = 0; range < colorRanges.size(); ++range) {
+					const Color& color = colorRanges[range].color;
+					const size_t end = range + 1 < colorRanges.size() ? colorRanges[range + 1].firstFace : triaSz;
+					for (size_t i = colorRanges[range].firstFace; i < end; ++i) {
+						unsigned char* target = &faceColors[(size_t)gpuMesh.indices[i * 3 + 2] * 4];
+						target[0] = color.r; target[1] = color.g; target[2] = color.b; target[3] = 255;
+					}
+				}
+				gl.glGenBuffers(1, &gpuMesh.faceColorBuffer);
+				gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.faceColorBuffer);
+				gl.glBufferData(GL_ARRAY_BUFFER, faceColors.size(), faceColors.data(), GL_STATIC_DRAW);
+			}
+
+			gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vertexBuffer);
+			gl.glBufferData(GL_ARRAY_BUFFER, gpuMesh.positions.size() * sizeof(float), gpuMesh.positions.data(), GL_STATIC_DRAW);
+			gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.colorBuffer);
+			gl.glBufferData(GL_ARRAY_BUFFER, (size_t)gpuMesh.vertexCount * 4, nullptr, GL_STREAM_DRAW);
+			gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			//Meshes with up to 65536 vertices store half sized indices. Host copy stays 32-bit for client side arrays
+			gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.indexBuffer);
+			if (gpuMesh.vertexCount <= 65536) {
+				std::vector<unsigned short> shortIndices(gpuMesh.indices.begin(), gpuMesh.indices.end());
+				gl.glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(unsigned short), shortIndices.data(), GL_STATIC_DRAW);
+				gpuMesh.indexType = GL_UNSIGNED_SHORT;
+			}
+			else { gl.glBufferData(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.indices.size() * sizeof(unsigned), gpuMesh.indices.data(), GL_STATIC_DRAW); }
+			gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		}
+		return MeshHandle(id);
+	}
+public:
+	///<summary>
+	///Frees buffers of uploaded mesh. Handle becomes invalid
+	///</summary>
+	void DestroyMesh(MeshHandle& handle) {
+		if (!handle.IsValid() || handle.id >= meshCache.size() || !meshCache[handle.id].inUse) { return; }
+
+		GpuMesh& gpuMesh = meshCache[handle.id];
+		if (gpuMesh.vertexBuffer) {
+			GLuint buffers[4] = { gpuMesh.vertexBuffer, gpuMesh.indexBuffer, gpuMesh.colorBuffer, gpuMesh.normalBuffer };
+			gl.glDeleteBuffers(4, buffers);
+			if (gpuMesh.faceColorBuffer) { gl.glDeleteBuffers(1, &gpuMesh.faceColorBuffer); }
+		}
+		gpuMesh = GpuMesh();
+		freeMeshSlots.push_back(handle.id);
+		handle = MeshHandle();
+	}
+	///<summary>
+	///Renders uploaded mesh with given parameters using one indexed draw call
+	///</summary>
+	void RenderMesh(MeshHandle handle, const Vector3& position, const Quaternion& rotation, const Color& color, const Material& material) {
+		RenderMesh(handle, Transform(position, rotation), color, material);
+	}
+	///<summary>
+	///Renders uploaded mesh with given transform using one draw call
+	///</summary>
+	void RenderMesh(MeshHandle handle, const Transform& transform, const Color& color, const Material& material) {
+		BeginMeshPass();
+		DrawMesh(handle, transform, color, material);
+	}
+private:
+	///<summary>
+	///Draws uploaded mesh inside pass, that is already timed. Renderer passes draw through it, so they are not split by "Mesh" pass
+	///</summary>
+	void DrawMesh(MeshHandle handle, const Transform& transform, const Color& color, const Material& material) {
+		PROFILE_SCOPE("Renderer::RenderMesh (MeshHandle)");
+		if (!handle.IsValid() || handle.id >= meshCache.size() || !meshCache[handle.id].inUse) { return; }
+
+		GpuMesh& gpuMesh = meshCache[handle.id];
+		if (!IsVisible(gpuMesh.bounds, transform)) { return; }
+		if (isGpuShadingEnabled && gpuMesh.normalBuffer && meshPrograms[material.shader].IsValid()) { RenderMeshProgram(gpuMesh, transform, color, material); return; }
+
+		if (IsPerVertex(material.shader)) { RenderMeshCorners(gpuMesh, transform, color, material); return; }
+
+		const bool useBuffers = gpuMesh.vertexBuffer != 0;
+		const bool isLit = material.shader != Material::unlit || !gpuMesh.colorRanges.empty();		/* batches need per face colors even unlit */
+
+		glPushMatrix();
+		MultiplyTransform(transform);
+
+		glEnableClientState(GL_VERTEX_ARRAY);
+		if (useBuffers) { gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vertexBuffer); }
+		glVertexPointer(3, GL_FLOAT, 0, useBuffers ? nullptr : gpuMesh.positions.data());
+
+		if (isLit) {
+			const size_t colorSz = (size_t)gpuMesh.vertexCount * 4;
+			unsigned char* colors = frameArena.Allocate<unsigned char>(colorSz);
+			ShadeFaces(gpuMesh, colors, transform, color, material);
+
+			glShadeModel(GL_FLAT);
+			glEnableClientState(GL_COLOR_ARRAY);
+			if (useBuffers) {
+				gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.colorBuffer);
+				gl.glBufferData(GL_ARRAY_BUFFER, colorSz, nullptr, GL_STREAM_DRAW);
+				gl.glBufferSubData(GL_ARRAY_BUFFER, 0, colorSz, colors);
+			}
+			glColorPointer(4, GL_UNSIGNED_BYTE, 0, useBuffers ? nullptr : colors);
+		}
+		else { glColor3ub(color.r, color.g, color.b); }
+
+		if (useBuffers) {
+			gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.indexBuffer);
+			glDrawElements(GL_TRIANGLES, gpuMesh.indexCount, gpuMesh.indexType, nullptr);
+			gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		else { glDrawElements(GL_TRIANGLES, gpuMesh.indexCount, GL_UNSIGNED_INT, gpuMesh.indices.data()); }
+
+		if (isLit) {
+			glDisableClientState(GL_COLOR_ARRAY);
+			glShadeModel(GL_SMOOTH);
+		}
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glPopMatrix();
+	}
+	///<summary>
+	///Starts GPU pass of loose RenderMesh() calls, unless it is running. One pass times all of them up to the next renderer pass,
+	///as query per draw would run out of scopes
+	///</summary>
+	void BeginMeshPass(void) {
+		if (gpuMeshScope == GpuProfiler::InvalidScope) { gpuMeshScope = gpuProfiler.BeginScope("Mesh"); }
+	}
+	///<summary>
+	///Ends GPU pass of loose RenderMesh() calls. Called before every other pass starts, so passes do not overlap
+	///</summary>
+	void EndMeshPass(void) {
+		gpuProfiler.EndScope(gpuMeshScope);
+		gpuMeshScope = GpuProfiler::InvalidScope;
+	}
+	///<summary>
+	///Renders uploaded mesh with material lit per vertex. Shared vertices get other color in every face, so corners are expanded
+	///from index buffer into frame scratch memory and drawn smooth without indices
+	///</summary>
+	void RenderMeshCorners(const GpuMesh& gpuMesh, const Transform& transform, const Color& color, const Material& material) {
+		const size_t cornerSz = gpuMesh.indices.size();
+		float* corners = frameArena.Allocate<float>(cornerSz * 3);
+		unsigned char* colors = frameArena.Allocate<unsigned char>(cornerSz * 4);
+
+		const unsigned* indices = gpuMesh.indices.data();
+		const float* positions = gpuMesh.positions.data();
+		ParallelForRanges(cornerSz, [&](size_t begin, size_t end) {
+			for (size_t k = begin; k < end; ++k) { memcpy(&corners[k * 3], &positions[(size_t)indices[k] * 3], 3 * sizeof(float)); }
+		});
+		ShadeFaces(gpuMesh, colors, transform, color, material);
+
+		glPushMatrix();
+		MultiplyTransform(transform);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, corners);
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei)cornerSz);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glPopMatrix();
+	}
+	///<summary>
+	///Renders uploaded mesh with GLSL program of its material. Transform, color and lighting are computed on GPU
+	///</summary>
+	void RenderMeshProgram(const GpuMesh& gpuMesh, const Transform& transform, const Color& color, const Material& material) {
+		const MaterialUniforms& uniforms = meshUniforms[material.shader];
+		gl.glUseProgram(meshPrograms[material.shader].GetId());
+		SetMaterialUniforms(uniforms, material);
+		gl.glUniform3f(uniforms.modelPosition, transform.position.x, transform.position.y, transform.position.z);
+		gl.glUniform4f(uniforms.modelRotation, transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w);
+		gl.glUniform3f(uniforms.modelScale, transform.scale.x, transform.scale.y, transform.scale.z);
+
+		gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vertexBuffer);
+		gl.glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+		gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.normalBuffer);
+		gl.glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+		gl.glEnableVertexAttribArray(0);
+		gl.glEnableVertexAttribArray(1);
+		if (gpuMesh.faceColorBuffer) {
+			gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.faceColorBuffer);
+			gl.glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, nullptr);
+			gl.glEnableVertexAttribArray(2);
+		}
+		else { gl.glVertexAttrib4f(2, color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, 1.0f); }
+
+		gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.indexBuffer);
+		glDrawElements(GL_TRIANGLES, gpuMesh.indexCount, gpuMesh.indexType, nullptr);
+
+		gl.glDisableVertexAttribArray(0);
+		gl.glDisableVertexAttribArray(1);
+		if (gpuMesh.faceColorBuffer) { gl.glDisableVertexAttribArray(2); }
+		gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gl.glUseProgram(0);
+	}
+public:
+	///<summary>
+	///Enables lighting of uploaded meshes in GLSL programs instead of CPU. Enabled by default, used only when IsGpuShadingAvailable()
+	///</summary>
+	void SetGpuShading(bool enabled) { isGpuShadingEnabled = enabled; }
+	///<summary>
+	///Returns true if material programs were compiled in init()
+	///</summary>
+	bool IsGpuShadingAvailable(void) const { return meshPrograms[0].IsValid() && meshPrograms[1].IsValid() && meshPrograms[2].IsValid() && meshPrograms[3].IsValid(); }
+	///<summary>
+	///Enables rejection of meshes outside camera view before any per-vertex work. Enabled by default
+	///</summary>
+	void SetFrustumCulling(bool enabled) { isCullingEnabled = enabled; }
+	///<summary>
+	///Sets allowed screen space error of level of detail in pixels, and part of it used as switching margin
+	///</summary>
+	void SetLodError(float pixelError, float hysteresis) { lodPixelError = pixelError; lodHysteresis = hysteresis; }
+	///<summary>
+	///Renders level of detail mesh. Level is chosen from distance to camera and kept in given per-instance state
+	///</summary>
+	void RenderMesh(const LodMesh& lodMesh, LodState& state, const Vector3& position, const Quaternion& rotation, const Color& color, const Material& material) {
+		PROFILE_SCOPE("Renderer::RenderMesh (LodMesh)");
+		if (lodMesh.levels.empty() || !IsVisible(lodMesh.levels[0].GetBoundingSphere(), Transform(position, rotation))) { return; }
+		RenderMesh(lodMesh.Select(state, camera.GetPixelsPerUnit(position, viewportHeight), lodPixelError, lodHysteresis), position, rotation, color, material);
+	}
+	///<summary>
+	///Uploads every level of detail mesh. Free it with DestroyLod()
+	///</summary>
+	LodHandle UploadLod(const LodMesh& lodMesh) {
+		LodHandle handle;
+		handle.errors = lodMesh.errors;
+		handle.levels.reserve(lodMesh.levels.size());
+		for (size_t i = 0; i < lodMesh.levels.size(); ++i) { handle.levels.push_back(UploadMesh(lodMesh.levels[i])); }
+		return handle;
+	}
+	void DestroyLod(LodHandle& handle) {
+		for (size_t i = 0; i < handle.levels.size(); ++i) { DestroyMesh(handle.levels[i]); }
+		handle = LodHandle();
+	}
+	///<summary>
+	///Renders uploaded level of detail mesh. Level is chosen from distance to camera and kept in given per-instance state
+	///</summary>
+	void RenderMesh(const LodHandle& handle, LodState& state, const Vector3& position, const Quaternion& rotation, const Color& color, const Material& material) {
+		PROFILE_SCOPE("Renderer::RenderMesh (LodHandle)");
+		if (handle.levels.empty()) { return; }
+		state.level = LodMesh::SelectLevel(handle.errors, state.level, camera.GetPixelsPerUnit(position, viewportHeight), lodPixelError, lodHysteresis);
+		RenderMesh(handle.levels[state.level], position, rotation, color, material);
+	}
+	///<summary>
+	///Renders uploaded mesh at every given transform with one instanced draw call. Colors may be nullptr for white.
+	///Instances outside camera view are skipped. Without OpenGL 3.3 every instance is drawn with RenderMesh()
+	///</summary>
+	void RenderMeshInstanced(MeshHandle handle, const Transform* transforms, const Color* colors, size_t count, const Material& material) {
+		PROFILE_SCOPE("Renderer::RenderMeshInstanced");
+		if (!handle.IsValid() || handle.id >= meshCache.size() || !meshCache[handle.id].inUse || count == 0) { return; }
+		EndMeshPass();
+
+		const GpuMesh& gpuMesh = meshCache[handle.id];
+		const ShaderProgram& program = instancedPrograms[material.shader];
+		if (!program.IsValid() || !gpuMesh.normalBuffer) {
+			GPU_PROFILE_SCOPE(gpuProfiler, "Mesh instanced");
+			for (size_t i = 0; i < count; ++i) { DrawMesh(handle, transforms[i], colors ? colors[i] : Color(255, 255, 255), material); }
+			return;
+		}
+
+		//Ranges are culled in parallel, each into its own part of the array, then visible instances are packed in order
+		InstanceData* instances = frameArena.Allocate<InstanceData>(count);
+		size_t* rangeCounts = frameArena.Allocate<size_t>((count + RendererJobGrain - 1) / RendererJobGrain);
+		const Frustum& frustum = camera.GetFrustum();
+		const bool isCulling = isCullingEnabled;
+		ParallelForRanges(count, [&](size_t begin, size_t end) {
+			size_t visible = begin;
+			for (size_t i = begin; i < end; ++i) {
+				const Transform& transform = transforms[i];
+				if (isCulling && !IsInFrustum(frustum, gpuMesh.bounds, transform)) { continue; }
+
+				InstanceData& instance = instances[visible++];
+				instance.position[0] = transform.position.x; instance.position[1] = transform.position.y; instance.position[2] = transform.position.z;
+				instance.rotation[0] = transform.rotation.x; instance.rotation[1] = transform.rotation.y; instance.rotation[2] = transform.rotation.z; instance.rotation[3] = transform.rotation.w;
+				instance.scale[0] = transform.scale.x; instance.scale[1] = transform.scale.y; instance.scale[2] = transform.scale.z;
+				const Color color = colors ? colors[i] : Color(255, 255, 255);
+				instance.color[0] = color.r; instance.color[1] = color.g; instance.color[2] = color.b; instance.color[3] = 255;
+			}
+			rangeCounts[begin / RendererJobGrain] = visible - begin;
+		});
+		size_t visibleCount = 0;
+		for (size_t begin = 0; begin < count; begin += RendererJobGrain) {
+			const size_t rangeVisible = rangeCounts[begin / RendererJobGrain];
+			if (visibleCount != begin) { memmove(&instances[visibleCount], &instances[begin], rangeVisible * sizeof(InstanceData)); }
+			visibleCount += rangeVisible;
+		}
+		culledMeshes += count - visibleCount;
+		if (visibleCount == 0) { return; }
+		GPU_PROFILE_SCOPE(gpuProfiler, "Mesh instanced");
+
+		gl.glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		gl.glBufferData(GL_ARRAY_BUFFER, visibleCount * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+		gl.glBufferSubData(GL_ARRAY_BUFFER, 0, visibleCount * sizeof(InstanceData), instances);
+
+		gl.glUseProgram(program.GetId());
+		SetMaterialUniforms(instancedUniforms[material.shader], material);
+
+		gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vertexBuffer);
+		gl.glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+		gl.glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.normalBuffer);
+		gl.glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+		gl.glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		gl.glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)offsetof(InstanceData, position));
+		gl.glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)offsetof(InstanceData, rotation));
+		gl.glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (const void*)offsetof(InstanceData, scale));
+		gl.glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData), (const void*)offsetof(InstanceData, color));
+		for (GLuint attribute = 0; attribute < 6; ++attribute) {
+			gl.glEnableVertexAttribArray(attribute);
+			gl.glVertexAttribDivisor(attribute, attribute < 2 ? 0 : 1);
+		}
+
+		gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.indexBuffer);
+		gl.glDrawElementsInstanced(GL_TRIANGLES, gpuMesh.indexCount, gpuMesh.indexType, nullptr, (GLsizei)visibleCount);
+
+		for (GLuint attribute = 0; attribute < 6; ++attribute) {
+			gl.glVertexAttribDivisor(attribute, 0);
+			gl.glDisableVertexAttribArray(attribute);
+		}
+		gl.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		gl.glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gl.glUseProgram(0);
+	}
+	///<summary>
+	///Renders uploaded mesh at every transform with color of same index. Empty colors draw every instance white,
+	///otherwise only instances, that have both transform and color, are drawn
+	///</summary>
+	void RenderMeshInstanced(MeshHandle handle, const std::vector<Transform>& transforms, const std::vector<Color>& colors, const Material& material) {
+		if (colors.empty()) { RenderMeshInstanced(handle, transforms.data(), nullptr, transforms.size(), material); return; }
+		RenderMeshInstanced(handle, transforms.data(), colors.data(), transforms.size() < colors.size() ? transforms.size() : colors.size(), material);
+	}
+	///<summary>
+	///Renders every entity with transform and mesh components. Entities without color or material use white unlit
+	///</summary>
+	void RenderWorld(const World& world) {
+		PROFILE_SCOPE("Renderer::RenderWorld");
+		EndMeshPass();
+		GPU_PROFILE_SCOPE(gpuProfiler, "World");
+		const Color defaultColor(255, 255, 255);
+		const Material defaultMaterial;
+
+		world.ForEachChunk(World::transform | World::mesh, [&](const EntityChunk& chunk) {
+			const bool hasColor = chunk.Has(World::color), hasMaterial = chunk.Has(World::material);
+			for (size_t i = 0; i < chunk.count; ++i) {
+				DrawMesh(chunk.meshes[i], Transform(chunk.positions[i], chunk.rotations[i], chunk.scales[i]),
+					hasColor ? chunk.colors[i] : defaultColor, hasMaterial ? chunk.materials[i] : defaultMaterial);
+			}
+		});
 	}
 	///<summary>
 	///Renders grid in XZ axis with given parameters
 	///</summary>
 	void RenderGrid(float startX, float endX, unsigned amountX, float startZ, float endZ, unsigned amountZ, float height, bool hasBorder, const Color& color) {
+		PROFILE_SCOPE("Renderer::RenderGrid");
+		EndMeshPass();
+		GPU_PROFILE_SCOPE(gpuProfiler, "Grid");
 		glBegin(GL_LINES);
 		glColor3ub(color.r, color.g, color.b);
 
@@ -281,13 +1517,48 @@ public:
 	}
 
 	void BeginFrame(void) {
+		PROFILE_SCOPE("Renderer::BeginFrame");
+		gpuProfiler.BeginFrame();
+		gpuFrameScope = gpuProfiler.BeginScope("Frame");
+		frameArena.Reset();
+		culledMeshes = 0;
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		viewportHeight = viewport[3] > 0 ? (float)viewport[3] : 1.0f;
+
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
 
 		camera.UpdatePosition();
+		UpdateCameraBlock();
 	}
 	void EndFrame(void) {
+		PROFILE_SCOPE("Renderer::EndFrame");
+		EndMeshPass();
+		gpuProfiler.EndScope(gpuFrameScope);
+		gpuFrameScope = GpuProfiler::InvalidScope;
 		glFlush();
 	}
+	///<summary>
+	///Returns GPU pass timer. Wrap own passes in GPU_PROFILE_SCOPE(renderer.GetGpuProfiler(), "Name"); call its Resolve() before writing profile.
+	///Loose RenderMesh() calls are timed together as "Mesh" pass, from the first of them to the next renderer pass or EndFrame()
+	///</summary>
+	GpuProfiler& GetGpuProfiler(void) { return gpuProfiler; }
+	///<summary>
+	///Returns amount of heap allocations made by the frame scratch memory since BeginFrame(). Zero in a steady-state frame
+	///</summary>
+	size_t GetFrameAllocations(void) const { return frameArena.GetFrameAllocations(); }
+	///<summary>
+	///Returns amount of meshes rejected by frustum culling since BeginFrame()
+	///</summary>
+	size_t GetCulledMeshes(void) const { return culledMeshes; }
+	///<summary>
+	///Returns mesh as it was uploaded: rotated indices and positions with duplicated provoking vertices. Nullptr for invalid handle
+	///</summary>
+	const GpuMesh* GetUploadedMesh(MeshHandle handle) const {
+		if (!handle.IsValid() || handle.id >= meshCache.size() || !meshCache[handle.id].inUse) { return nullptr; }
+		return &meshCache[handle.id];
+	}
 };
\ No newline at end of file
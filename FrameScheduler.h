@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+/*
+  - Frame scheduler header
+  - Decides when to render frames and advances simulation with a fixed timestep
+
+  - FrameScheduler.h:
+  - Contains realisations for FrameScheduler
+*/
+
+class FrameScheduler {
+public:
+	enum Mode {
+		continuous = 0,		// render every frame, paced to target rate
+		vsync = 1,			// render every frame, paced by buffer swap with swap interval 1
+		onDemand = 2		// render only after RequestRedraw() or while animating, otherwise idle
+	};
+	///<summary>
+	///GetWaitTimeout() result, when there is nothing to wait for but input
+	///</summary>
+	static const long InfiniteWait = -1;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Mode mode;
+	double frameTime, fixedStep, maxFrameTime;
+	double accumulator, lastFrameTime;
+	bool isDirty, isAnimating;
+	Clock::time_point lastTime, nextFrame;
+
+	static double Seconds(Clock::duration duration) { return std::chrono::duration<double>(duration).count(); }
+
+public:
+	FrameScheduler() : FrameScheduler(continuous, 60, 60) {}
+	FrameScheduler(Mode schedulingMode, double targetRate, double simulationRate) {
+		mode = schedulingMode;
+		frameTime = 1.0 / targetRate;
+		fixedStep = 1.0 / simulationRate;
+		maxFrameTime = 0.25;
+		accumulator = 0;
+		lastFrameTime = 0;
+		isDirty = true;
+		isAnimating = false;
+		lastTime = Clock::now();
+		nextFrame = lastTime;
+	}
+
+	///<summary>
+	///Sets scheduling mode. Scene is redrawn once after switching
+	///</summary>
+	void SetMode(Mode newMode) { mode = newMode; isDirty = true; nextFrame = Clock::now(); }
+	Mode GetMode(void) const { return mode; }
+	///<summary>
+	///Sets frame rate limit for continuous and on-demand modes
+	///</summary>
+	void SetTargetRate(double framesPerSecond) { frameTime = 1.0 / framesPerSecond; }
+	///<summary>
+	///Returns simulation step in seconds
+	///</summary>
+	double GetFixedStep(void) const { return fixedStep; }
+	///<summary>
+	///Returns measured time between last two frames in seconds
+	///</summary>
+	double GetFrameTime(void) const { return lastFrameTime; }
+	///<summary>
+	///Returns part of fixed step, which is not simulated yet. In range [0; 1), use to interpolate between simulation states
+	///</summary>
+	double GetInterpolation(void) const { return accumulator / fixedStep; }
+	///<summary>
+	///Marks camera or scene as changed. In on-demand mode next frame will be rendered
+	///</summary>
+	void RequestRedraw(void) { isDirty = true; }
+	///<summary>
+	///Marks camera or scene as changing every simulation step, for example by free camera or moving entities. On-demand mode keeps stepping meanwhile
+	///</summary>
+	void SetAnimating(bool animating) { isAnimating = animating; }
+	///<summary>
+	///Returns true if nothing has to be simulated or rendered, so the caller may block until next input event
+	///</summary>
+	bool IsIdle(void) const { return mode == onDemand && !isDirty && !isAnimating; }
+	///<summary>
+	///Returns milliseconds, that on-demand mode may block waiting for input: 0 if frame is due, time to next fixed step while animating,
+	///InfiniteWait when idle. Other modes never wait for input
+	///</summary>
+	long GetWaitTimeout(void) const {
+		if (mode != onDemand || isDirty) { return 0; }
+		if (!isAnimating) { return InfiniteWait; }
+
+		const double untilStep = fixedStep - accumulator - Seconds(Clock::now() - lastTime);
+		return untilStep > 0 ? (long)ceil(untilStep * 1000) : 0;
+	}
+
+	///<summary>
+	///Measures elapsed time and returns amount of fixed simulation steps to run before rendering
+	///</summary>
+	unsigned BeginFrame(void) {
+		const Clock::time_point now = Clock::now();
+		lastFrameTime = Seconds(now - lastTime);
+		lastTime = now;
+
+		accumulator += lastFrameTime < maxFrameTime ? lastFrameTime : maxFrameTime; // do not try to catch up after stalls
+		unsigned steps = 0;
+		while (accumulator >= fixedStep) {
+			accumulator -= fixedStep;
+			++steps;
+		}
+		return steps;
+	}
+	///<summary>
+	///Returns true if frame should be rendered now
+	///</summary>
+	bool ShouldRender(void) const { return mode != onDemand || isDirty; }
+	///<summary>
+	///Must be called after frame was rendered or skipped
+	///</summary>
+	void EndFrame(void) { isDirty = false; }
+	///<summary>
+	///Sleeps until next frame in continuous and on-demand modes. In vsync mode buffer swap paces frames instead
+	///</summary>
+	void WaitForNextFrame(void) {
+		if (mode == vsync) { return; }
+
+		const Clock::time_point now = Clock::now();
+		nextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frameTime));
+		if (nextFrame < now) { nextFrame = now; return; } // frame took too long, do not accumulate debt
+
+		const Clock::duration spinTime = std::chrono::milliseconds(2); // sleep is coarse, spin for the rest
+		if (nextFrame - now > spinTime) { std::this_thread::sleep_for(nextFrame - now - spinTime); }
+		while (Clock::now() < nextFrame) { std::this_thread::yield(); }
+	}
+};
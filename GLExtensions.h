@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include "Platform.h"
+
+/*
+  - OpenGL extensions header
+  - Loads OpenGL entry points newer than 1.1, which are not exported by the system OpenGL library
+
+  - GLExtensions.h:
+  - Contains realisations for GLExtensions
+
+  - Dependencies:
+  - Platform.h
+*/
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_VERSION_1_5
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+
+#define GL_ARRAY_BUFFER				0x8892
+#define GL_ELEMENT_ARRAY_BUFFER		0x8893
+#define GL_STREAM_DRAW				0x88E0
+#define GL_STATIC_DRAW				0x88E4
+#define GL_DYNAMIC_DRAW				0x88E8
+#define GL_QUERY_RESULT				0x8866
+#define GL_QUERY_RESULT_AVAILABLE	0x8867
+#endif
+
+#ifndef GL_VERSION_2_0
+typedef char GLchar;
+
+#define GL_FRAGMENT_SHADER			0x8B30
+#define GL_VERTEX_SHADER			0x8B31
+#define GL_COMPILE_STATUS			0x8B81
+#define GL_LINK_STATUS				0x8B82
+#define GL_INFO_LOG_LENGTH			0x8B84
+#endif
+
+#ifndef GL_VERSION_3_1
+#define GL_UNIFORM_BUFFER			0x8A11
+#define GL_INVALID_INDEX			0xFFFFFFFFu
+#endif
+
+#ifndef GL_VERSION_3_2
+typedef long long GLint64;
+typedef unsigned long long GLuint64;
+#endif
+
+#ifndef GL_VERSION_3_3
+#define GL_TIMESTAMP				0x8E28
+#endif
+
+class GLExtensions {
+public:
+	typedef void (APIENTRY* PGenBuffers)(GLsizei n, GLuint* buffers);
+	typedef void (APIENTRY* PDeleteBuffers)(GLsizei n, const GLuint* buffers);
+	typedef void (APIENTRY* PBindBuffer)(GLenum target, GLuint buffer);
+	typedef void (APIENTRY* PBufferData)(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+	typedef void (APIENTRY* PBufferSubData)(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+
+	PGenBuffers		glGenBuffers = nullptr;
+	PDeleteBuffers	glDeleteBuffers = nullptr;
+	PBindBuffer		glBindBuffer = nullptr;
+	PBufferData		glBufferData = nullptr;
+	PBufferSubData	glBufferSubData = nullptr;
+
+	typedef GLuint (APIENTRY* PCreateShader)(GLenum type);
+	typedef void (APIENTRY* PShaderSource)(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+	typedef void (APIENTRY* PCompileShader)(GLuint shader);
+	typedef void (APIENTRY* PGetShaderiv)(GLuint shader, GLenum pname, GLint* params);
+	typedef void (APIENTRY* PGetShaderInfoLog)(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+	typedef void (APIENTRY* PDeleteShader)(GLuint shader);
+	typedef GLuint (APIENTRY* PCreateProgram)(void);
+	typedef void (APIENTRY* PAttachShader)(GLuint program, GLuint shader);
+	typedef void (APIENTRY* PBindAttribLocation)(GLuint program, GLuint index, const GLchar* name);
+	typedef void (APIENTRY* PLinkProgram)(GLuint program);
+	typedef void (APIENTRY* PGetProgramiv)(GLuint program, GLenum pname, GLint* params);
+	typedef void (APIENTRY* PGetProgramInfoLog)(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+	typedef void (APIENTRY* PDeleteProgram)(GLuint program);
+	typedef void (APIENTRY* PUseProgram)(GLuint program);
+	typedef GLint (APIENTRY* PGetUniformLocation)(GLuint program, const GLchar* name);
+	typedef void (APIENTRY* PUniform1i)(GLint location, GLint v0);
+	typedef void (APIENTRY* PUniform1f)(GLint location, GLfloat v0);
+	typedef void (APIENTRY* PUniform3f)(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+	typedef void (APIENTRY* PUniform4f)(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+	typedef void (APIENTRY* PUniformMatrix4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+	typedef void (APIENTRY* PEnableVertexAttribArray)(GLuint index);
+	typedef void (APIENTRY* PDisableVertexAttribArray)(GLuint index);
+	typedef void (APIENTRY* PVertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+	typedef void (APIENTRY* PVertexAttrib4f)(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+
+	PCreateShader				glCreateShader = nullptr;
+	PShaderSource				glShaderSource = nullptr;
+	PCompileShader				glCompileShader = nullptr;
+	PGetShaderiv				glGetShaderiv = nullptr;
+	PGetShaderInfoLog			glGetShaderInfoLog = nullptr;
+	PDeleteShader				glDeleteShader = nullptr;
+	PCreateProgram				glCreateProgram = nullptr;
+	PAttachShader				glAttachShader = nullptr;
+	PBindAttribLocation			glBindAttribLocation = nullptr;
+	PLinkProgram				glLinkProgram = nullptr;
+	PGetProgramiv				glGetProgramiv = nullptr;
+	PGetProgramInfoLog			glGetProgramInfoLog = nullptr;
+	PDeleteProgram				glDeleteProgram = nullptr;
+	PUseProgram					glUseProgram = nullptr;
+	PGetUniformLocation			glGetUniformLocation = nullptr;
+	PUniform1i					glUniform1i = nullptr;
+	PUniform1f					glUniform1f = nullptr;
+	PUniform3f					glUniform3f = nullptr;
+	PUniform4f					glUniform4f = nullptr;
+	PUniformMatrix4fv			glUniformMatrix4fv = nullptr;
+	PEnableVertexAttribArray	glEnableVertexAttribArray = nullptr;
+	PDisableVertexAttribArray	glDisableVertexAttribArray = nullptr;
+	PVertexAttribPointer		glVertexAttribPointer = nullptr;
+	PVertexAttrib4f				glVertexAttrib4f = nullptr;
+
+	typedef void (APIENTRY* PDrawElementsInstanced)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+	typedef void (APIENTRY* PVertexAttribDivisor)(GLuint index, GLuint divisor);
+
+	PDrawElementsInstanced		glDrawElementsInstanced = nullptr;
+	PVertexAttribDivisor		glVertexAttribDivisor = nullptr;
+
+	typedef GLuint (APIENTRY* PGetUniformBlockIndex)(GLuint program, const GLchar* uniformBlockName);
+	typedef void (APIENTRY* PUniformBlockBinding)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+	typedef void (APIENTRY* PBindBufferBase)(GLenum target, GLuint index, GLuint buffer);
+
+	PGetUniformBlockIndex		glGetUniformBlockIndex = nullptr;
+	PUniformBlockBinding		glUniformBlockBinding = nullptr;
+	PBindBufferBase				glBindBufferBase = nullptr;
+
+	typedef void (APIENTRY* PGenQueries)(GLsizei n, GLuint* ids);
+	typedef void (APIENTRY* PDeleteQueries)(GLsizei n, const GLuint* ids);
+	typedef void (APIENTRY* PQueryCounter)(GLuint id, GLenum target);
+	typedef void (APIENTRY* PGetQueryObjectiv)(GLuint id, GLenum pname, GLint* params);
+	typedef void (APIENTRY* PGetQueryObjectui64v)(GLuint id, GLenum pname, GLuint64* params);
+	typedef void (APIENTRY* PGetInteger64v)(GLenum pname, GLint64* data);
+
+	PGenQueries					glGenQueries = nullptr;
+	PDeleteQueries				glDeleteQueries = nullptr;
+	PQueryCounter				glQueryCounter = nullptr;
+	PGetQueryObjectiv			glGetQueryObjectiv = nullptr;
+	PGetQueryObjectui64v		glGetQueryObjectui64v = nullptr;
+	PGetInteger64v				glGetInteger64v = nullptr;
+
+private:
+	bool isLoaded = false;
+
+	static void* GetProc(const char* name) { return RenderContext::GetFunctionAddress(name); }
+
+public:
+	///<summary>
+	///Loads all entry points. Must be called with a current OpenGL context. Safe to call several times
+	///</summary>
+	void Load(void) {
+		if (isLoaded) { return; }
+
+		glGenBuffers	= (PGenBuffers)GetProc("glGenBuffers");
+		glDeleteBuffers	= (PDeleteBuffers)GetProc("glDeleteBuffers");
+		glBindBuffer	= (PBindBuffer)GetProc("glBindBuffer");
+		glBufferData	= (PBufferData)GetProc("glBufferData");
+		glBufferSubData	= (PBufferSubData)GetProc("glBufferSubData");
+
+		glCreateShader				= (PCreateShader)GetProc("glCreateShader");
+		glShaderSource				= (PShaderSource)GetProc("glShaderSource");
+		glCompileShader				= (PCompileShader)GetProc("glCompileShader");
+		glGetShaderiv				= (PGetShaderiv)GetProc("glGetShaderiv");
+		glGetShaderInfoLog			= (PGetShaderInfoLog)GetProc("glGetShaderInfoLog");
+		glDeleteShader				= (PDeleteShader)GetProc("glDeleteShader");
+		glCreateProgram				= (PCreateProgram)GetProc("glCreateProgram");
+		glAttachShader				= (PAttachShader)GetProc("glAttachShader");
+		glBindAttribLocation		= (PBindAttribLocation)GetProc("glBindAttribLocation");
+		glLinkProgram				= (PLinkProgram)GetProc("glLinkProgram");
+		glGetProgramiv				= (PGetProgramiv)GetProc("glGetProgramiv");
+		glGetProgramInfoLog			= (PGetProgramInfoLog)GetProc("glGetProgramInfoLog");
+		glDeleteProgram				= (PDeleteProgram)GetProc("glDeleteProgram");
+		glUseProgram				= (PUseProgram)GetProc("glUseProgram");
+		glGetUniformLocation		= (PGetUniformLocation)GetProc("glGetUniformLocation");
+		glUniform1i					= (PUniform1i)GetProc("glUniform1i");
+		glUniform1f					= (PUniform1f)GetProc("glUniform1f");
+		glUniform3f					= (PUniform3f)GetProc("glUniform3f");
+		glUniform4f					= (PUniform4f)GetProc("glUniform4f");
+		glUniformMatrix4fv			= (PUniformMatrix4fv)GetProc("glUniformMatrix4fv");
+		glEnableVertexAttribArray	= (PEnableVertexAttribArray)GetProc("glEnableVertexAttribArray");
+		glDisableVertexAttribArray	= (PDisableVertexAttribArray)GetProc("glDisableVertexAttribArray");
+		glVertexAttribPointer		= (PVertexAttribPointer)GetProc("glVertexAttribPointer");
+		glVertexAttrib4f			= (PVertexAttrib4f)GetProc("glVertexAttrib4f");
+
+		glDrawElementsInstanced		= (PDrawElementsInstanced)GetProc("glDrawElementsInstanced");
+		glVertexAttribDivisor		= (PVertexAttribDivisor)GetProc("glVertexAttribDivisor");
+
+		glGetUniformBlockIndex		= (PGetUniformBlockIndex)GetProc("glGetUniformBlockIndex");
+		glUniformBlockBinding		= (PUniformBlockBinding)GetProc("glUniformBlockBinding");
+		glBindBufferBase			= (PBindBufferBase)GetProc("glBindBufferBase");
+
+		glGenQueries				= (PGenQueries)GetProc("glGenQueries");
+		glDeleteQueries				= (PDeleteQueries)GetProc("glDeleteQueries");
+		glQueryCounter				= (PQueryCounter)GetProc("glQueryCounter");
+		glGetQueryObjectiv			= (PGetQueryObjectiv)GetProc("glGetQueryObjectiv");
+		glGetQueryObjectui64v		= (PGetQueryObjectui64v)GetProc("glGetQueryObjectui64v");
+		glGetInteger64v				= (PGetInteger64v)GetProc("glGetInteger64v");
+
+		isLoaded = true;
+	}
+	///<summary>
+	///Returns true if vertex and index buffer objects (OpenGL 1.5) are available
+	///</summary>
+	bool HasBuffers(void) const { return glGenBuffers && glDeleteBuffers && glBindBuffer && glBufferData && glBufferSubData; }
+	///<summary>
+	///Returns true if GLSL programs and generic vertex attributes (OpenGL 2.0) are available
+	///</summary>
+	bool HasShaders(void) const {
+		return glCreateShader && glShaderSource && glCompileShader && glGetShaderiv && glGetShaderInfoLog && glDeleteShader
+			&& glCreateProgram && glAttachShader && glBindAttribLocation && glLinkProgram && glGetProgramiv && glGetProgramInfoLog && glDeleteProgram && glUseProgram
+			&& glGetUniformLocation && glUniform1i && glUniform1f && glUniform3f && glUniform4f && glUniformMatrix4fv
+			&& glEnableVertexAttribArray && glDisableVertexAttribArray && glVertexAttribPointer && glVertexAttrib4f;
+	}
+	///<summary>
+	///Returns true if instanced draws with per-instance attributes (OpenGL 3.3) are available
+	///</summary>
+	bool HasInstancing(void) const { return HasBuffers() && HasShaders() && glDrawElementsInstanced && glVertexAttribDivisor; }
+	///<summary>
+	///Returns true if uniform blocks backed by buffers (OpenGL 3.1) are available
+	///</summary>
+	bool HasUniformBlocks(void) const { return HasBuffers() && HasShaders() && glGetUniformBlockIndex && glUniformBlockBinding && glBindBufferBase; }
+	///<summary>
+	///Returns true if GPU timestamp queries (OpenGL 3.3 or ARB_timer_query) are available
+	///</summary>
+	bool HasTimerQueries(void) const { return glGenQueries && glDeleteQueries && glQueryCounter && glGetQueryObjectiv && glGetQueryObjectui64v && glGetInteger64v; }
+};
@@ -10,7 +10,7 @@
   - Basic vector, quaternion, matrix math
  
   - Geometry.h:
-  - Contains realisations for Vector2, Vector3, Quaternion, Matrix
+  - Contains realisations for Vector2, Vector3, Quaternion, Matrix, Transform, Matrix4x4, BoundingBox, BoundingSphere, Plane, Frustum
 */
 
 typedef struct Quaternion {
@@ -19,12 +19,15 @@ typedef struct Quaternion {
 	Quaternion() { x = 0; y = 0; z = 0; w = 1; }
 	Quaternion(float X, float Y, float Z, float W) { x = X; y = Y; z = Z; w = W; }
 
-	Quaternion operator*(const Quaternion& second) {
+	///<summary>
+	///Returns rotation by second quaternion followed by this one
+	///</summary>
+	Quaternion operator*(const Quaternion& second) const {
 		return Quaternion (
-			w * second.w - x * second.x - y * second.y - z * second.z,
 			w * second.x + x * second.w + y * second.z - z * second.y,
 			w * second.y - x * second.z + y * second.w + z * second.x,
-			w * second.z + x * second.y - y * second.x + z * second.w
+			w * second.z + x * second.y - y * second.x + z * second.w,
+			w * second.w - x * second.x - y * second.y - z * second.z
 		);
 	}
 
@@ -197,7 +200,7 @@ typedef struct Vector3 {
 
 		eulerangles.y = atan2f(sinr_cosp, cosr_cosp);
 		eulerangles.x = atan2f(siny_cosp, cosy_cosp);
-		eulerangles.y = (fabs(sinp) >= 1) ? (copysignf(1.5707963f, sinp)) : (std::asinf(sinp)); // use 90 degrees if out of range
+		eulerangles.y = (fabs(sinp) >= 1) ? (copysignf(1.5707963f, sinp)) : (asinf(sinp)); // use 90 degrees if out of range
 		
 		return eulerangles / 2;
 	}
@@ -272,4 +275,221 @@ public:
 	Transform(const Vector3& nPos) { position = nPos; rotation = Quaternion(); scale = Vector3(1, 1, 1); }
 	Transform(const Vector3& nPos, const Quaternion& nRot) { position = nPos; rotation = nRot; scale = Vector3(1, 1, 1); }
 	Transform(const Vector3& nPos, const Quaternion& nRot, const Vector3& nScale) { position = nPos; rotation = nRot; scale = nScale; }
-};
\ No newline at end of file
+};
+
+typedef struct Matrix4x4 {
+	///<summary>
+	///Column-major elements, same layout as OpenGL. Element at (row, column) is m[column * 4 + row]
+	///</summary>
+	float m[16];
+
+	Matrix4x4() { for (int i = 0; i < 16; ++i) { m[i] = (i % 5 == 0) ? 1.0f : 0.0f; } }
+	Matrix4x4(const float elements[16]) { for (int i = 0; i < 16; ++i) { m[i] = elements[i]; } }
+
+	float& operator()(int row, int column) { return m[column * 4 + row]; }
+	float operator()(int row, int column) const { return m[column * 4 + row]; }
+
+	Matrix4x4 operator*(const Matrix4x4& second) const {
+		Matrix4x4 result;
+		for (int c = 0; c < 4; ++c) {
+			for (int r = 0; r < 4; ++r) {
+				result.m[c * 4 + r] =
+					m[r] * second.m[c * 4] +
+					m[4 + r] * second.m[c * 4 + 1] +
+					m[8 + r] * second.m[c * 4 + 2] +
+					m[12 + r] * second.m[c * 4 + 3];
+			}
+		}
+		return result;
+	}
+
+	///<summary>
+	///Returns identity matrix
+	///</summary>
+	static Matrix4x4 Identity(void) { return Matrix4x4(); }
+	///<summary>
+	///Returns matrix, that shifts points by given Vector3
+	///</summary>
+	static Matrix4x4 Translation(const Vector3& position) {
+		Matrix4x4 result;
+		result.m[12] = position.x; result.m[13] = position.y; result.m[14] = position.z;
+		return result;
+	}
+	///<summary>
+	///Returns matrix, that multiplies points by scale on each axis
+	///</summary>
+	static Matrix4x4 Scale(const Vector3& scale) {
+		Matrix4x4 result;
+		result.m[0] = scale.x; result.m[5] = scale.y; result.m[10] = scale.z;
+		return result;
+	}
+	///<summary>
+	///Returns matrix, that rotates points same as Vector3::Rotation() with given Quaternion
+	///</summary>
+	static Matrix4x4 Rotation(const Quaternion& q) {
+		const float d = q.w * q.w - (q.x * q.x + q.y * q.y + q.z * q.z);
+		Matrix4x4 result;
+
+		result(0, 0) = 2 * q.x * q.x + d;			result(0, 1) = 2 * (q.x * q.y - q.w * q.z);	result(0, 2) = 2 * (q.x * q.z + q.w * q.y);
+		result(1, 0) = 2 * (q.x * q.y + q.w * q.z);	result(1, 1) = 2 * q.y * q.y + d;			result(1, 2) = 2 * (q.y * q.z - q.w * q.x);
+		result(2, 0) = 2 * (q.x * q.z - q.w * q.y);	result(2, 1) = 2 * (q.y * q.z + q.w * q.x);	result(2, 2) = 2 * q.z * q.z + d;
+		return result;
+	}
+	///<summary>
+	///Returns matrix, that scales, then rotates, then shifts points. Same order as Mesh::ApplyTransform()
+	///</summary>
+	static Matrix4x4 TRS(const Vector3& position, const Quaternion& rotation, const Vector3& scale) {
+		Matrix4x4 result = Rotation(rotation);
+		for (int r = 0; r < 3; ++r) {
+			result.m[r] *= scale.x;
+			result.m[4 + r] *= scale.y;
+			result.m[8 + r] *= scale.z;
+		}
+		result.m[12] = position.x; result.m[13] = position.y; result.m[14] = position.z;
+		return result;
+	}
+	///<summary>
+	///Returns matrix of given Transform
+	///</summary>
+	static Matrix4x4 FromTransform(const Transform& transform) { return TRS(transform.position, transform.rotation, transform.scale); }
+
+	///<summary>
+	///Returns transposed variant of this Matrix4x4
+	///</summary>
+	Matrix4x4 Transposed(void) const {
+		Matrix4x4 result;
+		for (int r = 0; r < 4; ++r) { for (int c = 0; c < 4; ++c) { result.m[c * 4 + r] = m[r * 4 + c]; } }
+		return result;
+	}
+	///<summary>
+	///Returns inverse of this Matrix4x4. Returns identity if matrix is singular
+	///</summary>
+	Matrix4x4 Inverse(void) const {
+		float inv[16];
+
+		inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+		inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+		inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+		inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+		inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+		inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+		inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+		inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+		float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+		if (det == 0) { return Matrix4x4(); }
+
+		det = 1.0f / det;
+		for (int i = 0; i < 16; ++i) { inv[i] *= det; }
+		return Matrix4x4(inv);
+	}
+	///<summary>
+	///Returns given point transformed by this matrix (with translation, w = 1)
+	///</summary>
+	Vector3 MultiplyPoint(const Vector3& point) const {
+		return Vector3(
+			m[0] * point.x + m[4] * point.y + m[8] * point.z + m[12],
+			m[1] * point.x + m[5] * point.y + m[9] * point.z + m[13],
+			m[2] * point.x + m[6] * point.y + m[10] * point.z + m[14]
+		);
+	}
+	///<summary>
+	///Returns given direction transformed by this matrix (without translation, w = 0)
+	///</summary>
+	Vector3 MultiplyVector(const Vector3& vector) const {
+		return Vector3(
+			m[0] * vector.x + m[4] * vector.y + m[8] * vector.z,
+			m[1] * vector.x + m[5] * vector.y + m[9] * vector.z,
+			m[2] * vector.x + m[6] * vector.y + m[10] * vector.z
+		);
+	}
+	///<summary>
+	///Transforms given amount of points. Source and destination may be the same
+	///</summary>
+	void TransformPoints(const Vector3* source, Vector3* destination, size_t count) const {
+		for (size_t i = 0; i < count; ++i) { destination[i] = MultiplyPoint(source[i]); }
+	}
+	///<summary>
+	///Transforms given amount of directions. Source and destination may be the same
+	///</summary>
+	void TransformVectors(const Vector3* source, Vector3* destination, size_t count) const {
+		for (size_t i = 0; i < count; ++i) { destination[i] = MultiplyVector(source[i]); }
+	}
+} Matrix4x4;
+
+///<summary>
+///Axis aligned bounding box
+///</summary>
+typedef struct BoundingBox {
+	Vector3 min, max;
+
+	BoundingBox() { min = Vector3(); max = Vector3(); }
+	BoundingBox(const Vector3& Min, const Vector3& Max) { min = Min; max = Max; }
+
+	Vector3 Center(void) const { return (Vector3(min) + max) / 2; }
+	///<summary>
+	///Returns half of box size on each axis
+	///</summary>
+	Vector3 Extents(void) const { return (Vector3(max) - min) / 2; }
+} BoundingBox;
+
+typedef struct BoundingSphere {
+	Vector3 center;
+	float radius;
+
+	BoundingSphere() { center = Vector3(); radius = 0; }
+	BoundingSphere(const Vector3& Center, float Radius) { center = Center; radius = Radius; }
+} BoundingSphere;
+
+///<summary>
+///Plane with points p, for which Dot(normal, p) + distance = 0. Normal points to positive half-space
+///</summary>
+typedef struct Plane {
+	Vector3 normal;
+	float distance;
+
+	Plane() { normal = Vector3(0, 1, 0); distance = 0; }
+	Plane(const Vector3& Normal, const Vector3& point) { normal = Vector3(Normal).Normal(); distance = -Vector3::Dot(normal, point); }
+
+	///<summary>
+	///Returns signed distance from plane to point. Positive on normal side
+	///</summary>
+	float Distance(const Vector3& point) const { return Vector3::Dot(normal, point) + distance; }
+} Plane;
+
+///<summary>
+///Six planes of camera view volume with normals pointing inside: left, right, bottom, top, near, far
+///</summary>
+typedef struct Frustum {
+	Plane planes[6];
+
+	///<summary>
+	///Returns false if sphere is completely outside. May return true for some spheres near frustum corners
+	///</summary>
+	bool Intersects(const BoundingSphere& sphere) const {
+		for (int i = 0; i < 6; ++i) {
+			if (planes[i].Distance(sphere.center) < -sphere.radius) { return false; }
+		}
+		return true;
+	}
+	///<summary>
+	///Returns false if box is completely outside. May return true for some boxes near frustum corners
+	///</summary>
+	bool Intersects(const BoundingBox& box) const {
+		const Vector3 center = box.Center(), extents = box.Extents();
+		for (int i = 0; i < 6; ++i) {
+			const Vector3& n = planes[i].normal;
+			const float reach = extents.x * fabsf(n.x) + extents.y * fabsf(n.y) + extents.z * fabsf(n.z);
+			if (planes[i].Distance(center) < -reach) { return false; }
+		}
+		return true;
+	}
+} Frustum;
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <vector>
+#include "Platform.h"
+#include "GLExtensions.h"
+#include "Profiler.h"
+
+/*
+  - GPU profiler header
+  - Times GPU work of scoped passes with timestamp queries. Queries of a frame are read back a few frames later,
+    so the pipeline never stalls, and results go to "GPU" track of Profiler in the same timeline as CPU zones
+
+  - GpuProfiler.h:
+  - Contains realisations for GpuProfiler, GpuProfileScope
+
+  - Dependencies:
+  - Platform.h
+  - GLExtensions.h
+  - Profiler.h
+*/
+
+#define GpuProfilerFrameLatency	4		// frames in flight; queries of a frame are read when its slot comes round again
+#define GpuProfilerMaxScopes	256		// timed scopes per frame, later ones are skipped
+
+///<summary>
+///Ring of timestamp query sets, one per frame in flight. Scopes are recorded only while Profiler is enabled
+///</summary>
+class GpuProfiler {
+public:
+	///<summary>
+	///Scope handle of skipped scope
+	///</summary>
+	static const unsigned InvalidScope = 0xFFFFFFFFu;
+
+private:
+	typedef struct Frame {
+		GLuint queries[GpuProfilerMaxScopes * 2];	// begin and end timestamp of each scope
+		const char* names[GpuProfilerMaxScopes];
+		bool isEnded[GpuProfilerMaxScopes];
+		unsigned scopeCount;
+		GLuint lastQuery;							// results become available in issue order, so this one is checked
+		long long clockOffset;						// Profiler::Now() minus GPU time at frame start, nanoseconds
+	} Frame;
+
+	GLExtensions gl;								// only query entry points are set, copied so profiler stays valid when owner is moved
+	std::vector<Frame> frames;
+	ProfilerTrack* track = nullptr;
+	unsigned current = 0;
+	bool isFrameOpen = false;
+	size_t droppedFrames = 0;
+
+	///<summary>
+	///Pushes finished scopes of frame to GPU track. Without wait frame, which results are not ready, is dropped
+	///</summary>
+	void Resolve(Frame& frame, bool wait) {
+		if (frame.scopeCount == 0) { return; }
+
+		GLint isAvailable = 0;
+		if (!wait) { gl.glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable); }
+		if (wait || isAvailable) {
+			for (unsigned i = 0; i < frame.scopeCount; ++i) {
+				if (!frame.isEnded[i]) { continue; }
+				GLuint64 begin = 0, end = 0;
+				gl.glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+				gl.glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+				track->Push(frame.names[i], (long long)begin + frame.clockOffset, (long long)end + frame.clockOffset);
+			}
+		}
+		else { ++droppedFrames; }
+		frame.scopeCount = 0;
+	}
+
+public:
+	///<summary>
+	///Creates query objects. Needs current context and loaded extensions. Returns false if timer queries are not supported or profiler is compiled out
+	///</summary>
+	bool Create(const GLExtensions& extensions) {
+		if (IsValid()) { return true; }
+#ifdef PROFILER_DISABLED
+		(void)extensions;
+		return false;
+#else
+		if (!extensions.HasTimerQueries()) { return false; }
+
+		gl.glGenQueries = extensions.glGenQueries;
+		gl.glDeleteQueries = extensions.glDeleteQueries;
+		gl.glQueryCounter = extensions.glQueryCounter;
+		gl.glGetQueryObjectiv = extensions.glGetQueryObjectiv;
+		gl.glGetQueryObjectui64v = extensions.glGetQueryObjectui64v;
+		gl.glGetInteger64v = extensions.glGetInteger64v;
+		frames.resize(GpuProfilerFrameLatency);
+		for (size_t f = 0; f < frames.size(); ++f) {
+			gl.glGenQueries(GpuProfilerMaxScopes * 2, frames[f].queries);
+			frames[f].scopeCount = 0;
+			frames[f].lastQuery = 0;
+			frames[f].clockOffset = 0;
+		}
+		return true;
+#endif
+	}
+	void Destroy(void) {
+		for (size_t f = 0; f < frames.size(); ++f) { gl.glDeleteQueries(GpuProfilerMaxScopes * 2, frames[f].queries); }
+		frames.clear();
+		isFrameOpen = false;
+	}
+	bool IsValid(void) const { return !frames.empty(); }
+
+	///<summary>
+	///Moves to next frame slot, reading back queries issued GpuProfilerFrameLatency frames ago. Scopes are recorded until next call
+	///</summary>
+	void BeginFrame(void) {
+		if (!IsValid()) { return; }
+
+		current = (current + 1) % GpuProfilerFrameLatency;
+		Frame& frame = frames[current];
+		Resolve(frame, false);
+
+		isFrameOpen = Profiler::Get().IsEnabled();
+		if (!isFrameOpen) { return; }
+		if (!track) { track = &Profiler::Get().CreateTrack("GPU"); }
+
+		GLint64 gpuNow = 0;
+		gl.glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		frame.clockOffset = Profiler::Now() - (long long)gpuNow;
+	}
+	///<summary>
+	///Issues begin timestamp of named scope. Name must have static lifetime. Returns InvalidScope if scope is not timed
+	///</summary>
+	unsigned BeginScope(const char* name) {
+		if (!isFrameOpen) { return InvalidScope; }
+
+		Frame& frame = frames[current];
+		if (frame.scopeCount == GpuProfilerMaxScopes) { return InvalidScope; }
+
+		const unsigned index = frame.scopeCount++;
+		frame.names[index] = name;
+		frame.isEnded[index] = false;
+		frame.lastQuery = frame.queries[index * 2];
+		gl.glQueryCounter(frame.lastQuery, GL_TIMESTAMP);
+		return current * GpuProfilerMaxScopes + index;
+	}
+	///<summary>
+	///Issues end timestamp of scope returned by BeginScope()
+	///</summary>
+	void EndScope(unsigned scope) {
+		if (scope == InvalidScope || !IsValid()) { return; }
+
+		Frame& frame = frames[scope / GpuProfilerMaxScopes];
+		const unsigned index = scope % GpuProfilerMaxScopes;
+		if (index >= frame.scopeCount) { return; }	// frame was read back meanwhile
+
+		frame.isEnded[index] = true;
+		frame.lastQuery = frame.queries[index * 2 + 1];
+		gl.glQueryCounter(frame.lastQuery, GL_TIMESTAMP);
+	}
+	///<summary>
+	///Reads back every frame in flight, waiting for GPU. Call before Profiler::WriteTrace() to include the last frames
+	///</summary>
+	void Resolve(void) {
+		for (unsigned i = 1; i <= frames.size(); ++i) { Resolve(frames[(current + i) % GpuProfilerFrameLatency], true); }
+		isFrameOpen = false;
+	}
+	///<summary>
+	///Returns amount of frames, which results were not ready when read back, and were skipped to avoid stall
+	///</summary>
+	size_t GetDroppedFrames(void) const { return droppedFrames; }
+};
+
+///<summary>
+///Times GPU commands issued from construction to end of scope
+///</summary>
+class GpuProfileScope {
+private:
+	GpuProfiler& profiler;
+	unsigned scope;
+
+public:
+	GpuProfileScope(GpuProfiler& gpuProfiler, const char* name) : profiler(gpuProfiler) { scope = profiler.BeginScope(name); }
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+	~GpuProfileScope() { profiler.EndScope(scope); }
+};
+
+#ifdef PROFILER_DISABLED
+#define GPU_PROFILE_SCOPE(gpuProfiler, name)
+#else
+#define GPU_PROFILE_SCOPE(gpuProfiler, name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(gpuProfiler, name)
+#endif
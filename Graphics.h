@@ -1,19 +1,31 @@
 #pragma once
 
+#include <atomic>
+#include <cstring>
 #include <vector>
+#include <initializer_list>
+#include <unordered_map>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 #include "Geometry.h"
+#include "Memory.h"
+#include "Simd.h"
+#include "Jobs.h"
 
 /*
   - Graphics math header
   - Basic color, shader, material, mesh math, rendering tools
   
   - Graphics.h:
-  - Contains realisations for Color, Material, Triangle, Mesh
+  - Contains realisations for Color, Material, ShadingConstants, MaterialKernel, Triangle, VertexStream, Mesh, MeshView, StaticBatch, LodMesh
   
   - Dependencies:
   - Geometry.h
+  - Memory.h
+  - Simd.h
+  - Jobs.h
 */
 
 typedef struct Color {
@@ -27,7 +39,9 @@ public:
 
 	Color() { r = 0; g = 0; b = 0; }
 	Color(Vector3 fromVector3) { r = (unsigned char)fromVector3.x; g = (unsigned char)fromVector3.y; b = (unsigned char)fromVector3.z; }
+#ifdef _WIN32
 	Color(COLORREF fromColorRef) { b = (fromColorRef >> 16) & 0xFF; g = (fromColorRef >> 8) & 0xFF; r = fromColorRef & 0xFF; }
+#endif
 	Color(long R, long G, long B) { r = ClampColor(R); g = ClampColor(G); b = ClampColor(B); }
 
 	Color operator*(const float& value) { return Color((long)(value * r), (long)(value * g), (long)(value * b)); }
@@ -87,6 +101,68 @@ public:
 	Material(Shader shaderType, float Metallic, float Roughness) { shader = shaderType; metallic = Metallic * 0.75f; roughness = Roughness; metal = Color(108, 107, 117); }
 };
 
+///<summary>
+///Material and camera values shared by every triangle of one draw. Built once per mesh, so shading loops do no per-triangle setup
+///</summary>
+typedef struct ShadingConstants {
+	Vector3 cameraNormal, cameraPosition;
+	///<summary>
+	///Divisor of Vector3::Angle() for unit face normals: camera normal length + 1
+	///</summary>
+	float angleDivisor;
+	float inverseRoughness, doubleRoughness, farClipInverse;
+	///<summary>
+	///Mesh color, mesh color lerped to metal and to face orientation colors
+	///</summary>
+	Color color, metalColor, frontColor, backColor;
+
+	ShadingConstants(const Material& material, const Color& meshColor, const Vector3& cameraNormalToUse, const Vector3& cameraPositionToUse, float farClip) {
+		cameraNormal = cameraNormalToUse; cameraPosition = cameraPositionToUse;
+		angleDivisor = Vector3::Distance(cameraNormal) + 1;
+		inverseRoughness = 1 - material.roughness; doubleRoughness = 2 * material.roughness; farClipInverse = 1 / farClip;
+		color = meshColor;
+		metalColor = Color::Lerp(meshColor, material.metal, material.metallic);
+		frontColor = Color::Lerp(meshColor, material.facefront, material.faceorientfactor);
+		backColor = Color::Lerp(meshColor, material.faceback, material.faceorientfactor);
+	}
+	///<summary>
+	///Returns Vector3::Angle() between camera normal and given unit face normal
+	///</summary>
+	float Angle(const Vector3& normal) const { return Vector3::Dot(cameraNormal, normal) / angleDivisor; }
+	float DiffusePoint(float angle) const { angle = inverseRoughness * fabsf(angle) - inverseRoughness; return 1 - angle * angle; }
+} ShadingConstants;
+
+///<summary>
+///Shading of one material type, resolved at compile time. isLit: needs face normal, isPerVertex: light depends on vertex position.
+///Shaded color is Color(Base()) * Factor(): Base() picks color for face with given normal angle, Factor() is light intensity at given position
+///</summary>
+template<Material::Shader shader> struct MaterialKernel;
+
+template<> struct MaterialKernel<Material::unlit> {
+	static const bool isLit = false, isPerVertex = false;
+	static const Color& Base(const ShadingConstants& constants, float) { return constants.color; }
+	static float Factor(const ShadingConstants&, float, const Vector3&) { return 1; }
+};
+template<> struct MaterialKernel<Material::diffuse> {
+	static const bool isLit = true, isPerVertex = false;
+	static const Color& Base(const ShadingConstants& constants, float) { return constants.metalColor; }
+	static float Factor(const ShadingConstants& constants, float angle, const Vector3&) { return constants.DiffusePoint(angle); }
+};
+template<> struct MaterialKernel<Material::realistic> {
+	static const bool isLit = true, isPerVertex = true;
+	static const Color& Base(const ShadingConstants& constants, float) { return constants.metalColor; }
+	static float Factor(const ShadingConstants& constants, float angle, const Vector3& position) {
+		float distanceFactor = Vector3::Distance(constants.cameraPosition, position) * constants.farClipInverse;
+		distanceFactor = distanceFactor < 0 ? 0 : distanceFactor > 1 ? 1 : distanceFactor;
+		return fabsf(angle) * constants.DiffusePoint(angle) * (constants.doubleRoughness - distanceFactor);
+	}
+};
+template<> struct MaterialKernel<Material::faceorient> {
+	static const bool isLit = true, isPerVertex = false;
+	static const Color& Base(const ShadingConstants& constants, float angle) { return angle < 0 ? constants.frontColor : constants.backColor; }
+	static float Factor(const ShadingConstants& constants, float angle, const Vector3&) { return constants.DiffusePoint(angle); }
+};
+
 typedef struct Vertex3 {
 	Vector3 position;
 	Color color;
@@ -103,16 +179,20 @@ typedef struct Triangle {
 	Triangle(const Vector3& A, const Vector3& B, const Vector3& C, const Color& color) { a = Vertex3(A, color), b = Vertex3(B, color), c = Vertex3(C, color); }
 
 	///<summary>
-	///Returns normal vector of current triangle
+	///Returns normal vector of triangle with given vertex positions
 	///</summary>
-	Vector3 Normal(void) const {
-		float vx1 = a.position.x - b.position.x, vx2 = b.position.x - c.position.x;
-		float vy1 = a.position.y - b.position.y, vy2 = b.position.y - c.position.y;
-		float vz1 = a.position.z - b.position.z, vz2 = b.position.z - c.position.z;
+	static Vector3 Normal(const Vector3& a, const Vector3& b, const Vector3& c) {
+		float vx1 = a.x - b.x, vx2 = b.x - c.x;
+		float vy1 = a.y - b.y, vy2 = b.y - c.y;
+		float vz1 = a.z - b.z, vz2 = b.z - c.z;
 
 		return Vector3(vy1 * vz2 - vz1 * vy2, vz1 * vx2 - vx1 * vz2, vx1 * vy2 - vy1 * vx2).Normal();
 	}
 	///<summary>
+	///Returns normal vector of current triangle
+	///</summary>
+	Vector3 Normal(void) const { return Normal(a.position, b.position, c.position); }
+	///<summary>
 	///Sets all vertex colors to given one
 	///</summary>
 	void SetColor(const Color& color) {
@@ -130,69 +210,325 @@ typedef struct Triangle {
 	}
 } Triangle;
 
+///<summary>
+///Structure-of-arrays list of Vector3 points. Stores separate 32-byte aligned x, y, z streams
+///</summary>
+class VertexStream {
+private:
+	typedef std::vector<float, AlignedAllocator<float, 32>> Stream;
+	Stream x, y, z;
+	///<summary>
+	///Identifier of current content. Reset to 0 by every change, new one is taken in GetVersion(). Copies share it
+	///</summary>
+	mutable unsigned long long version = 0;
+
+public:
+	VertexStream() {}
+	VertexStream(std::initializer_list<Vector3> points) { insert(0, points.begin(), points.size()); }
+	VertexStream(const std::vector<Vector3>& points) { insert(0, points.data(), points.size()); }
+
+	///<summary>
+	///Returns point with given index
+	///</summary>
+	Vector3 operator[](size_t index) const { return Vector3(x[index], y[index], z[index]); }
+	///<summary>
+	///Sets point with given index
+	///</summary>
+	void Set(size_t index, const Vector3& point) { x[index] = point.x; y[index] = point.y; z[index] = point.z; version = 0; }
+
+	size_t size(void) const { return x.size(); }
+	bool empty(void) const { return x.empty(); }
+	void reserve(size_t count) { x.reserve(count); y.reserve(count); z.reserve(count); }
+	void resize(size_t count) { x.resize(count); y.resize(count); z.resize(count); version = 0; }
+	void clear(void) { x.clear(); y.clear(); z.clear(); version = 0; }
+	void push_back(const Vector3& point) { x.push_back(point.x); y.push_back(point.y); z.push_back(point.z); version = 0; }
+	///<summary>
+	///Inserts given amount of points before index
+	///</summary>
+	void insert(size_t index, const Vector3* points, size_t count) {
+		x.insert(x.begin() + index, count, 0); y.insert(y.begin() + index, count, 0); z.insert(z.begin() + index, count, 0);
+		for (size_t i = 0; i < count; ++i) { Set(index + i, points[i]); }
+	}
+	void insert(size_t index, const std::vector<Vector3>& points) { insert(index, points.data(), points.size()); }
+	void insert(size_t index, const VertexStream& points) {
+		x.insert(x.begin() + index, points.x.begin(), points.x.end());
+		y.insert(y.begin() + index, points.y.begin(), points.y.end());
+		z.insert(z.begin() + index, points.z.begin(), points.z.end());
+		version = 0;
+	}
+
+	///<summary>
+	///Returns writable stream. Content is treated as changed
+	///</summary>
+	float* GetX(void) { version = 0; return x.data(); }
+	float* GetY(void) { version = 0; return y.data(); }
+	float* GetZ(void) { version = 0; return z.data(); }
+	const float* GetX(void) const { return x.data(); }
+	const float* GetY(void) const { return y.data(); }
+	const float* GetZ(void) const { return z.data(); }
+	///<summary>
+	///Returns identifier, that changes whenever content changes. Used to know if cached data derived from stream is still valid
+	///</summary>
+	unsigned long long GetVersion(void) const {
+		static std::atomic<unsigned long long> lastVersion(0);
+		if (version == 0) { version = ++lastVersion; }
+		return version;
+	}
+};
+
+///<summary>
+///List of triangle indices with content version, like VertexStream. Read-only access matches std::vector<unsigned>
+///</summary>
+class IndexList {
+private:
+	std::vector<unsigned> indices;
+	///<summary>
+	///Identifier of current content. Reset to 0 by every change, new one is taken in GetVersion(). Copies share it
+	///</summary>
+	mutable unsigned long long version = 0;
+
+public:
+	IndexList() {}
+	IndexList(std::initializer_list<unsigned> list) : indices(list) {}
+	IndexList(const std::vector<unsigned>& list) : indices(list) {}
+
+	///<summary>
+	///Returns index with given position
+	///</summary>
+	unsigned operator[](size_t index) const { return indices[index]; }
+	///<summary>
+	///Sets index with given position
+	///</summary>
+	void Set(size_t index, unsigned value) { indices[index] = value; version = 0; }
+	///<summary>
+	///Returns indices as vector, for functions, that read std::vector<unsigned>
+	///</summary>
+	operator const std::vector<unsigned>&(void) const { return indices; }
+
+	size_t size(void) const { return indices.size(); }
+	bool empty(void) const { return indices.empty(); }
+	std::vector<unsigned>::const_iterator begin(void) const { return indices.begin(); }
+	std::vector<unsigned>::const_iterator end(void) const { return indices.end(); }
+	void reserve(size_t count) { indices.reserve(count); }
+	void resize(size_t count) { indices.resize(count); version = 0; }
+	void clear(void) { indices.clear(); version = 0; }
+	void push_back(unsigned value) { indices.push_back(value); version = 0; }
+	void assign(const unsigned* first, const unsigned* last) { indices.assign(first, last); version = 0; }
+	///<summary>
+	///Exchanges content with given vector
+	///</summary>
+	void swap(std::vector<unsigned>& other) { indices.swap(other); version = 0; }
+
+	///<summary>
+	///Returns writable indices. Content is treated as changed
+	///</summary>
+	unsigned* data(void) { version = 0; return indices.data(); }
+	const unsigned* data(void) const { return indices.data(); }
+	///<summary>
+	///Returns identifier, that changes whenever content changes. Used to know if cached data derived from indices is still valid
+	///</summary>
+	unsigned long long GetVersion(void) const {
+		static std::atomic<unsigned long long> lastVersion(0);
+		if (version == 0) { version = ++lastVersion; }
+		return version;
+	}
+};
+
 class Mesh {
 private:
-	
+	mutable unsigned long long boundsVersion = 0;
+	mutable BoundingBox boundingBox;
+	mutable BoundingSphere boundingSphere;
+
+	void UpdateBounds(void) const {
+		const unsigned long long currentVersion = vertices.GetVersion();
+		if (boundsVersion == currentVersion) { return; }
+		boundsVersion = currentVersion;
+
+		const size_t vertSz = vertices.size();
+		if (vertSz == 0) { boundingBox = BoundingBox(); boundingSphere = BoundingSphere(); return; }
+
+		const float* vx = vertices.GetX();
+		const float* vy = vertices.GetY();
+		const float* vz = vertices.GetZ();
+		float minX = vx[0], minY = vy[0], minZ = vz[0], maxX = vx[0], maxY = vy[0], maxZ = vz[0];
+		for (size_t i = 1; i < vertSz; ++i) {
+			minX = vx[i] < minX ? vx[i] : minX; maxX = vx[i] > maxX ? vx[i] : maxX;
+			minY = vy[i] < minY ? vy[i] : minY; maxY = vy[i] > maxY ? vy[i] : maxY;
+			minZ = vz[i] < minZ ? vz[i] : minZ; maxZ = vz[i] > maxZ ? vz[i] : maxZ;
+		}
+		boundingBox = BoundingBox(Vector3(minX, minY, minZ), Vector3(maxX, maxY, maxZ));
+
+		//Sphere around box center, radius reaches the farthest vertex
+		const Vector3 center = boundingBox.Center();
+		float radiusSq = 0;
+		for (size_t i = 0; i < vertSz; ++i) {
+			const float dx = vx[i] - center.x, dy = vy[i] - center.y, dz = vz[i] - center.z;
+			const float distanceSq = dx * dx + dy * dy + dz * dz;
+			radiusSq = distanceSq > radiusSq ? distanceSq : radiusSq;
+		}
+		boundingSphere = BoundingSphere(center, sqrtf(radiusSq));
+	}
+
+	mutable unsigned long long normalsVersion = 0, normalsIndexVersion = 0;
+	mutable VertexStream faceNormals;
+	mutable VertexStream vertexNormals;
+
+	void UpdateNormals(void) const {
+		const unsigned long long currentVersion = vertices.GetVersion(), currentIndexVersion = triangles.GetVersion();
+		if (normalsVersion == currentVersion && normalsIndexVersion == currentIndexVersion) { return; }
+		normalsVersion = currentVersion;
+		normalsIndexVersion = currentIndexVersion;
+
+		const size_t vertSz = vertices.size();
+		const size_t triaSz = triangles.size() / 3;
+		faceNormals.resize(triaSz);
+		vertexNormals.resize(vertSz);
+
+		const float* vx = vertices.GetX();
+		const float* vy = vertices.GetY();
+		const float* vz = vertices.GetZ();
+		float* fx = faceNormals.GetX();
+		float* fy = faceNormals.GetY();
+		float* fz = faceNormals.GetZ();
+		float* nx = vertexNormals.GetX();
+		float* ny = vertexNormals.GetY();
+		float* nz = vertexNormals.GetZ();
+		for (size_t i = 0; i < vertSz; ++i) { nx[i] = 0; ny[i] = 0; nz[i] = 0; }
+
+		for (size_t i = 0; i < triaSz; ++i) {
+			const unsigned a = triangles[i * 3], b = triangles[i * 3 + 1], c = triangles[i * 3 + 2];
+			const float vx1 = vx[a] - vx[b], vx2 = vx[b] - vx[c];
+			const float vy1 = vy[a] - vy[b], vy2 = vy[b] - vy[c];
+			const float vz1 = vz[a] - vz[b], vz2 = vz[b] - vz[c];
+			const Vector3 cross = Vector3(vy1 * vz2 - vz1 * vy2, vz1 * vx2 - vx1 * vz2, vx1 * vy2 - vy1 * vx2); // same as Triangle::Normal before normalization
+
+			const Vector3 normal = Vector3(cross).Normal();
+			fx[i] = normal.x; fy[i] = normal.y; fz[i] = normal.z;
+
+			//Cross length is twice the triangle area, so bigger faces weight more in vertex normal
+			nx[a] += cross.x; ny[a] += cross.y; nz[a] += cross.z;
+			nx[b] += cross.x; ny[b] += cross.y; nz[b] += cross.z;
+			nx[c] += cross.x; ny[c] += cross.y; nz[c] += cross.z;
+		}
+		for (size_t i = 0; i < vertSz; ++i) {
+			const Vector3 normal = Vector3(nx[i], ny[i], nz[i]).Normal();
+			nx[i] = normal.x; ny[i] = normal.y; nz[i] = normal.z;
+		}
+	}
+	///<summary>
+	///Marks cached normals as matching current vertices. Used after transforms, that update normals together with vertices
+	///</summary>
+	void KeepNormals(bool wereValid) {
+		if (wereValid) { normalsVersion = vertices.GetVersion(); }
+	}
+	bool HasValidNormals(void) const { return normalsVersion == vertices.GetVersion() && normalsIndexVersion == triangles.GetVersion(); }
+
 public:
 	///<summary>
 	///List of all mesh vertices
 	///</summary>
-	std::vector<Vector3> vertices;
+	VertexStream vertices;
 	///<summary>
 	///List of mesh triangles. Triangles are defined as 3-pair indexes to vertices
 	///</summary>
-	std::vector<unsigned> triangles;
+	IndexList triangles;
 
 	Mesh() { vertices = {}; triangles = {}; }
 	Mesh(const std::vector<Vector3>& vertexList, const std::vector<unsigned>& triangleList) { vertices = vertexList; triangles = triangleList; }
+	Mesh(const VertexStream& vertexList, const std::vector<unsigned>& triangleList) { vertices = vertexList; triangles = triangleList; }
 
 
-	Mesh operator+(const Mesh& second) {
-		Mesh addCombined = Mesh(vertices, triangles);
-
+	///<summary>
+	///Returns mesh with vertices and triangles of both meshes. Vertices of second mesh go after current ones
+	///</summary>
+	Mesh operator+(const Mesh& second) const {
+		Mesh addCombined;
+		addCombined.vertices.reserve(vertices.size() + second.vertices.size());
+		addCombined.triangles.reserve(triangles.size() + second.triangles.size());
+		addCombined += *this;
+		addCombined += second;
+		return addCombined;
+	}
+	///<summary>
+	///Appends vertices and triangles of given mesh. Reserve both lists first when appending many meshes
+	///</summary>
+	Mesh& operator+=(const Mesh& second) {
 		const unsigned szCurVerts = (unsigned)vertices.size();
 		const size_t szAddTris = second.triangles.size();
 
-		addCombined.vertices.insert(addCombined.vertices.begin(), second.vertices.begin(), second.vertices.end());
-
+		vertices.insert(vertices.size(), second.vertices);
 		for (size_t i = 0; i < szAddTris; ++i) {
-			addCombined.triangles.push_back(second.triangles[i] + szCurVerts);
+			triangles.push_back(second.triangles[i] + szCurVerts);
 		}
-		return addCombined;
+		return *this;
 	}
 
+	///<summary>
+	///Returns object space axis aligned bounds. Cached, recomputed only after vertices change
+	///</summary>
+	const BoundingBox& GetBoundingBox(void) const { UpdateBounds(); return boundingBox; }
+	///<summary>
+	///Returns object space bounding sphere. Cached, recomputed only after vertices change
+	///</summary>
+	const BoundingSphere& GetBoundingSphere(void) const { UpdateBounds(); return boundingSphere; }
+	///<summary>
+	///Returns unit normal of every triangle, in triangle order. Cached, recomputed only after vertices or triangles change
+	///</summary>
+	const VertexStream& GetFaceNormals(void) const { UpdateNormals(); return faceNormals; }
+	///<summary>
+	///Returns unit normal of every vertex: area weighted average of normals of triangles using it. Cached as face normals
+	///</summary>
+	const VertexStream& GetVertexNormals(void) const { UpdateNormals(); return vertexNormals; }
+	///<summary>
+	///Computes cached normals now instead of on first use, so new mesh is ready to be drawn and rotated
+	///</summary>
+	void RecalculateNormals(void) { UpdateNormals(); }
 	///<summary>
 	///Clears all vertices and triangles lists
 	///</summary>
 	void Clear(void) { vertices.clear(); triangles.clear(); }
 	///<summary>
-	///Shifts current mesh instance by given Vector3
+	///Returns true if every index refers to a vertex. Normals and bounds of mesh from untrusted source may be read only after this check
+	///</summary>
+	bool HasValidIndices(void) const {
+		const size_t vertSz = vertices.size(), indexSz = triangles.size();
+		for (size_t i = 0; i < indexSz; ++i) {
+			if (triangles[i] >= vertSz) { return false; }
+		}
+		return true;
+	}
+	///<summary>
+	///Shifts current mesh instance by given Vector3. Cached normals stay valid
 	///</summary>
 	void AddPosition(const Vector3& position) {
-		const size_t vertSz = vertices.size();
-		for (size_t i = 0; i < vertSz; ++i) { vertices[i] = vertices[i] + position; }
+		const bool wereValid = HasValidNormals();
+		VertexKernels::Translate(vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.size(), position);
+		KeepNormals(wereValid);
 	}
 	///<summary>
-	///Multiplies current mesh instance by given Quaternion
+	///Multiplies current mesh instance by given Quaternion. Cached normals are rotated too instead of being recomputed
 	///</summary>
 	void AddRotation(const Quaternion& rotation) {
-		const size_t vertSz = vertices.size();
-		for (size_t i = 0; i < vertSz; ++i) { vertices[i].Rotatate(rotation); }
+		const bool wereValid = HasValidNormals();
+		VertexKernels::Rotate(vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.size(), rotation);
+		if (wereValid) {
+			VertexKernels::Rotate(faceNormals.GetX(), faceNormals.GetY(), faceNormals.GetZ(), faceNormals.GetX(), faceNormals.GetY(), faceNormals.GetZ(), faceNormals.size(), rotation);
+			VertexKernels::Rotate(vertexNormals.GetX(), vertexNormals.GetY(), vertexNormals.GetZ(), vertexNormals.GetX(), vertexNormals.GetY(), vertexNormals.GetZ(), vertexNormals.size(), rotation);
+		}
+		KeepNormals(wereValid);
 	}
 	///<summary>
 	///Multiplies current mesh instance by scale on each axis
 	///</summary>
 	void AddScale(const Vector3& scale) {
-		const size_t vertSz = vertices.size();
-		for (size_t i = 0; i < vertSz; ++i) { vertices[i].MultiplyPairwise(scale); }
+		VertexKernels::Scale(vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.size(), scale);
 	}
 	///<summary>
 	///Applies transfrom to current mesh instance
 	///</summary>
 	void ApplyTransform(const Transform& transform) {
-		this->AddScale(transform.scale);
-		this->AddRotation(transform.rotation);
-		this->AddPosition(transform.position);
+		VertexKernels::Transform(vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.GetX(), vertices.GetY(), vertices.GetZ(), vertices.size(), Matrix4x4::FromTransform(transform));
 	}
 	///<summary>
 	///Generates Cone mesh with given parameters
@@ -204,7 +540,7 @@ public:
 		std::vector<Vector3> circle = Vector3::CirclePoints(sides, radius, Vector3(0, -height / 2.0f, 0), Quaternion());
 		
 		nCone.vertices.push_back(Vector3(0, height / 2.0f, 0));
-		nCone.vertices.insert(nCone.vertices.end(), circle.begin(), circle.end());
+		nCone.vertices.insert(nCone.vertices.size(), circle);
 
 		if (height > 0) {
 			for (unsigned i = 1; i < sides; ++i) {
@@ -226,6 +562,7 @@ public:
 			nCone.triangles.push_back(1);
 			nCone.triangles.push_back(0);
 		}
+		nCone.RecalculateNormals();
 		return nCone;
 	}
 	///<summary>
@@ -259,6 +596,7 @@ public:
 		nCylinder.triangles.push_back((sides << 1) - 1);
 		nCylinder.triangles.push_back(1);
 
+		nCylinder.RecalculateNormals();
 		return nCylinder;
 	}
 	///<summary>
@@ -283,12 +621,14 @@ public:
 				}
 			}
 		}
+		nCube.RecalculateNormals();
 		return nCube;
 	}
 	///<summary>
-	///Generates Low-poly Ico-Sphere mesh with given radius
+	///Generates Ico-Sphere mesh with given radius. Each subdivision splits every triangle into 4, level n has 20 * 4^n triangles and 10 * 4^n + 2 vertices.
+	///Subdivisions above 10 are clamped to 10: level 10 already has 20M triangles and needs about 1 GB while it is built
 	///</summary>
-	static Mesh GenerateIcoSphere(const float& radius) {
+	static Mesh GenerateIcoSphere(const float& radius, const unsigned& subdivisions = 0) {
 		Mesh nIco = Mesh();
 
 		const float sX = radius * 0.5257311f;
@@ -306,6 +646,238 @@ public:
 			Vector3(0, sZ, sX),		Vector3(0, sZ, -sX),	Vector3(0, -sZ, sX),	Vector3(0, -sZ, -sX),
 			Vector3(sZ, sX, 0),		Vector3(-sZ, sX, 0),	Vector3(sZ, -sX, 0),	Vector3(-sZ, -sX, 0)
 		};
+		if (subdivisions == 0) { nIco.RecalculateNormals(); return nIco; }
+
+		const unsigned levels = subdivisions < 10 ? subdivisions : 10; // 20M triangles, ~1 GB peak with subdivision buffers; each further level needs 4x memory and time
+		const size_t finalFactor = (size_t)1 << (2 * levels);
+		nIco.vertices.reserve(10 * finalFactor + 2);
+		nIco.triangles.reserve(60 * finalFactor);
+
+		std::vector<unsigned> subdivided;
+		subdivided.reserve(60 * finalFactor);
+		std::unordered_map<unsigned long long, unsigned> midpoints; // edge (smaller index, bigger index) -> midpoint vertex
+		midpoints.reserve(30 * (finalFactor >> 2));
+
+		//Returns index of vertex in the middle of edge, projected onto sphere. Shared edges get the same vertex
+		auto midpoint = [&](unsigned a, unsigned b) -> unsigned {
+			const unsigned long long key = a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+			auto inserted = midpoints.emplace(key, (unsigned)nIco.vertices.size());
+			if (inserted.second) { nIco.vertices.push_back((nIco.vertices[a] + nIco.vertices[b]).Normal() * radius); }
+			return inserted.first->second;
+		};
+
+		for (unsigned level = 0; level < levels; ++level) {
+			const size_t indexCount = nIco.triangles.size();
+			subdivided.clear();
+			midpoints.clear();
+
+			for (size_t i = 0; i < indexCount; i += 3) {
+				const unsigned a = nIco.triangles[i], b = nIco.triangles[i + 1], c = nIco.triangles[i + 2];
+				const unsigned ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+
+				const unsigned split[12] = { a, ab, ca,  ab, b, bc,  ca, bc, c,  ab, bc, ca }; // keeps winding of parent triangle
+				subdivided.insert(subdivided.end(), split, split + 12);
+			}
+			nIco.triangles.swap(subdivided);
+		}
+		nIco.RecalculateNormals();
 		return nIco;
 	}
+};
+
+///<summary>
+///Read-only view of mesh streams, that live elsewhere: in a Mesh or in a memory-mapped mesh file. Nothing is owned or copied,
+///so view is valid only while its source is alive and unchanged
+///</summary>
+typedef struct MeshView {
+	const float *x, *y, *z;
+	const float *faceNormalX, *faceNormalY, *faceNormalZ;
+	const float *vertexNormalX, *vertexNormalY, *vertexNormalZ;
+	const unsigned* triangles;
+	size_t vertexCount, indexCount;
+	BoundingBox boundingBox;
+	BoundingSphere boundingSphere;
+
+	MeshView() {
+		x = y = z = nullptr;
+		faceNormalX = faceNormalY = faceNormalZ = nullptr;
+		vertexNormalX = vertexNormalY = vertexNormalZ = nullptr;
+		triangles = nullptr;
+		vertexCount = 0; indexCount = 0;
+	}
+	///<summary>
+	///Views streams of given mesh. Its cached normals and bounds are brought up to date first
+	///</summary>
+	MeshView(const Mesh& mesh) {
+		const VertexStream& faceNormals = mesh.GetFaceNormals();
+		const VertexStream& vertexNormals = mesh.GetVertexNormals();
+		x = mesh.vertices.GetX(); y = mesh.vertices.GetY(); z = mesh.vertices.GetZ();
+		faceNormalX = faceNormals.GetX(); faceNormalY = faceNormals.GetY(); faceNormalZ = faceNormals.GetZ();
+		vertexNormalX = vertexNormals.GetX(); vertexNormalY = vertexNormals.GetY(); vertexNormalZ = vertexNormals.GetZ();
+		triangles = mesh.triangles.data();
+		vertexCount = mesh.vertices.size();
+		indexCount = mesh.triangles.size() / 3 * 3;
+		boundingBox = mesh.GetBoundingBox();
+		boundingSphere = mesh.GetBoundingSphere();
+	}
+
+	size_t GetTriangleCount(void) const { return indexCount / 3; }
+	///<summary>
+	///Returns true if every index refers to a viewed vertex. Check views of untrusted sources before indexing vertex streams with them
+	///</summary>
+	bool HasValidIndices(void) const {
+		for (size_t i = 0; i < indexCount; ++i) {
+			if (triangles[i] >= vertexCount) { return false; }
+		}
+		return true;
+	}
+	Vector3 GetVertex(size_t index) const { return Vector3(x[index], y[index], z[index]); }
+	Vector3 GetFaceNormal(size_t face) const { return Vector3(faceNormalX[face], faceNormalY[face], faceNormalZ[face]); }
+	///<summary>
+	///Copies viewed streams into new Mesh, that can be edited. Normals are recomputed by the mesh when requested
+	///</summary>
+	Mesh ToMesh(void) const {
+		Mesh mesh;
+		mesh.vertices.resize(vertexCount);
+		if (vertexCount > 0) {
+			memcpy(mesh.vertices.GetX(), x, vertexCount * sizeof(float));
+			memcpy(mesh.vertices.GetY(), y, vertexCount * sizeof(float));
+			memcpy(mesh.vertices.GetZ(), z, vertexCount * sizeof(float));
+		}
+		mesh.triangles.assign(triangles, triangles + indexCount);
+		return mesh;
+	}
+} MeshView;
+
+///<summary>
+///Faces, that share one color: from firstFace up to firstFace of next range
+///</summary>
+typedef struct ColorRange {
+	size_t firstFace;
+	Color color;
+
+	ColorRange() { firstFace = 0; }
+	ColorRange(size_t first, const Color& rangeColor) { firstFace = first; color = rangeColor; }
+} ColorRange;
+
+///<summary>
+///Collects static meshes, that share one material, and bakes them into one world space mesh, so they are drawn with one call.
+///Added meshes are referenced, not copied: keep them alive until Build(). Upload result with Renderer::UploadBatch()
+///</summary>
+class StaticBatch {
+private:
+	typedef struct Entry {
+		const Mesh* mesh;
+		Transform transform;
+		Color color;
+		size_t vertexOffset, indexOffset;
+	} Entry;
+
+	std::vector<Entry> entries;
+	size_t vertexCount = 0, indexCount = 0;
+
+public:
+	Material material;
+
+	StaticBatch() {}
+	StaticBatch(const Material& materialToUse) { material = materialToUse; }
+
+	///<summary>
+	///Adds mesh placed with given transform and painted with given color
+	///</summary>
+	void Add(const Mesh& mesh, const Transform& transform, const Color& color) {
+		Entry entry;
+		entry.mesh = &mesh; entry.transform = transform; entry.color = color;
+		entry.vertexOffset = vertexCount; entry.indexOffset = indexCount;
+		entries.push_back(entry);
+		vertexCount += mesh.vertices.size();
+		indexCount += mesh.triangles.size();
+	}
+	void Reserve(size_t entryCount) { entries.reserve(entryCount); }
+	void Clear(void) { entries.clear(); vertexCount = 0; indexCount = 0; }
+
+	size_t GetEntryCount(void) const { return entries.size(); }
+	size_t GetVertexCount(void) const { return vertexCount; }
+	size_t GetTriangleCount(void) const { return indexCount / 3; }
+	///<summary>
+	///Writes all entries into given mesh in world space, with color of every face range. Output is allocated once with exact sizes,
+	///entries are transformed in parallel, each one in one pass straight into its place
+	///</summary>
+	void Build(Mesh& mesh, std::vector<ColorRange>& colors) const {
+		mesh.Clear();
+		mesh.vertices.resize(vertexCount);
+		mesh.triangles.resize(indexCount);
+		colors.clear();
+
+		for (size_t e = 0; e < entries.size(); ++e) {
+			const Color& color = entries[e].color;
+			const bool isSameColor = !colors.empty() && colors.back().color.r == color.r && colors.back().color.g == color.g && colors.back().color.b == color.b;
+			if (!entries[e].mesh->triangles.empty() && !isSameColor) { colors.push_back(ColorRange(entries[e].indexOffset / 3, color)); }
+		}
+
+		float* vx = mesh.vertices.GetX();
+		float* vy = mesh.vertices.GetY();
+		float* vz = mesh.vertices.GetZ();
+		unsigned* indices = mesh.triangles.data();
+
+		JobSystem::Get().ParallelFor(entries.size(), [&](size_t e) {
+			const Entry& entry = entries[e];
+			const Mesh& source = *entry.mesh;
+			const size_t vertSz = source.vertices.size(), indexSz = source.triangles.size();
+
+			VertexKernels::Transform(source.vertices.GetX(), source.vertices.GetY(), source.vertices.GetZ(), vx + entry.vertexOffset, vy + entry.vertexOffset, vz + entry.vertexOffset, vertSz, Matrix4x4::FromTransform(entry.transform));
+			for (size_t i = 0; i < indexSz; ++i) { indices[entry.indexOffset + i] = source.triangles[i] + (unsigned)entry.vertexOffset; }
+		});
+	}
+};
+
+///<summary>
+///Level of detail state of one rendered instance. Keep one per object, so switching between levels is stable over frames
+///</summary>
+typedef struct LodState {
+	unsigned level;
+
+	LodState() { level = 0; }
+} LodState;
+
+///<summary>
+///Chain of mesh levels from full detail (level 0) to coarsest. Each level stores its geometric error: the largest distance between its surface and full detail surface in object units
+///</summary>
+class LodMesh {
+public:
+	std::vector<Mesh> levels;
+	///<summary>
+	///Geometric error of each level. Must grow with level, level 0 has error 0
+	///</summary>
+	std::vector<float> errors;
+
+	LodMesh() {}
+	LodMesh(const Mesh& fullDetail) { AddLevel(fullDetail, 0); }
+
+	///<summary>
+	///Appends coarser level with given geometric error
+	///</summary>
+	void AddLevel(const Mesh& mesh, float geometricError) { levels.push_back(mesh); errors.push_back(geometricError); }
+	size_t GetLevelCount(void) const { return levels.size(); }
+	const Mesh& GetLevel(unsigned level) const { return levels[level < levels.size() ? level : levels.size() - 1]; }
+
+	///<summary>
+	///Returns level to use when one object unit covers given amount of pixels. Picks coarsest level, which error is below pixelError.
+	///Hysteresis (part of pixelError) keeps current level while error is near the threshold, so levels do not pop back and forth
+	///</summary>
+	static unsigned SelectLevel(const std::vector<float>& levelErrors, unsigned current, float pixelsPerUnit, float pixelError, float hysteresis) {
+		if (levelErrors.empty()) { return 0; }
+
+		unsigned level = current < levelErrors.size() ? current : (unsigned)levelErrors.size() - 1;
+		while (level > 0 && levelErrors[level] * pixelsPerUnit > pixelError * (1 + hysteresis)) { --level; }
+		while (level + 1 < levelErrors.size() && levelErrors[level + 1] * pixelsPerUnit <= pixelError * (1 - hysteresis)) { ++level; }
+		return level;
+	}
+	///<summary>
+	///Updates level of given instance state and returns mesh to render
+	///</summary>
+	const Mesh& Select(LodState& state, float pixelsPerUnit, float pixelError, float hysteresis) const {
+		state.level = SelectLevel(errors, state.level, pixelsPerUnit, pixelError, hysteresis);
+		return GetLevel(state.level);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Scene.h"
+
+/*
+  - Headless Linux entry point
+  - Renders demo scene into offscreen framebuffer without window system, saves last frame as PPM image
+
+  - HeadlessMain.cpp:
+  - Contains main realisation
+
+  - Build (Mesa software rasterizer is enough):
+  - g++ -std=c++14 -O2 HeadlessMain.cpp -o headless -lEGL -lGL -lGLU -pthread
+  - Usage:
+  - ./headless [frames] [output.ppm] [trace.json]
+  - With trace path every frame is profiled and saved as Chrome trace
+*/
+
+#define HeadlessSizeX		1600
+#define HeadlessSizeY		900
+
+static bool SaveFramePPM(const char* path, int width, int height) {
+	std::vector<unsigned char> pixels((size_t)width * height * 3);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	FILE* file = fopen(path, "wb");
+	if (!file) { return false; }
+
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	for (int y = height - 1; y >= 0; --y) { fwrite(&pixels[(size_t)y * width * 3], 1, (size_t)width * 3, file); } // OpenGL rows go bottom to top
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv) {
+	const int frames = argc > 1 ? atoi(argv[1]) : 1;
+	const char* outputPath = argc > 2 ? argv[2] : "frame.ppm";
+	const char* tracePath = argc > 3 ? argv[3] : nullptr;
+
+	RenderContext renderContext;
+	if (!renderContext.CreateOffscreen(HeadlessSizeX, HeadlessSizeY) || !renderContext.MakeCurrent()) { fprintf(stderr, "RenderContext::CreateOffscreen() failed\n"); return 1; }
+	printf("%s, OpenGL %s\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+
+	Renderer renderer = Renderer(Camera(Vector3(3, 4, 3), Vector3(0, 1, 0)));
+	DemoScene scene;
+
+	renderer.init();
+	printf("Material shading: %s\n", renderer.IsGpuShadingAvailable() ? "GLSL programs" : "CPU");
+	printf("Job workers: %u\n", (unsigned)JobSystem::Get().GetWorkerCount());
+	scene.Load(renderer);
+
+	float time = 0;
+	if (tracePath) {
+		Profiler::Get().SetThreadName("Main");
+		Profiler::Get().SetEnabled(true);
+	}
+
+	for (int frame = 0; frame < frames; ++frame) {
+		if (frames > 1) {
+			renderer.camera.SetCameraPosition(Vector3(5 * cosf(time), 4, 5 * sinf(time)));
+			time += 0.01793473f;
+		}
+
+		PROFILE_SCOPE("Frame");
+		renderer.BeginFrame();
+		scene.Draw(renderer);
+		renderer.EndFrame();
+	}
+
+	if (tracePath) {
+		renderer.GetGpuProfiler().Resolve();
+		if (!Profiler::Get().WriteTrace(tracePath)) { fprintf(stderr, "Can not write %s\n", tracePath); }
+		else { printf("Saved profile to %s\n", tracePath); }
+	}
+
+	if (!SaveFramePPM(outputPath, HeadlessSizeX, HeadlessSizeY)) { fprintf(stderr, "Can not write %s\n", outputPath); }
+	else { printf("Saved %d frame(s), last one to %s\n", frames, outputPath); }
+
+	scene.Unload(renderer);
+	renderContext.Destroy();
+	return 0;
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  - Job system header
+  - Engine-wide scheduler: worker threads with own job deques, work stealing, parallel for over ranges,
+    dependency counters and waits, that keep running jobs instead of blocking
+
+  - Jobs.h:
+  - Contains realisations for JobCounter, Job, JobQueue, JobSystem
+*/
+
+#define JobQueueCapacity	4096	// power of two; job, that does not fit, runs right away on the pushing thread
+
+///<summary>
+///Amount of unfinished jobs of a group. Wait for it with JobSystem::Wait(), or make it dependency of later jobs
+///</summary>
+typedef struct JobCounter {
+	std::atomic<int> pending;
+
+	JobCounter() { pending.store(0); }
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone(void) const { return pending.load(std::memory_order_acquire) == 0; }
+} JobCounter;
+
+///<summary>
+///Function with its data and index range. Stored by value, so scheduling allocates nothing
+///</summary>
+typedef struct Job {
+	typedef void (*Function)(void* data, size_t begin, size_t end);
+
+	Function function;
+	void* data;
+	size_t begin, end;
+	JobCounter* counter;
+	///<summary>
+	///Job starts only after this counter is done. Null for no dependency
+	///</summary>
+	const JobCounter* dependency;
+} Job;
+
+///<summary>
+///Deque of one worker. Owner pushes and pops newest jobs at the bottom, other workers steal oldest ones from the top
+///</summary>
+class JobQueue {
+private:
+	std::mutex mutex;
+	std::vector<Job> jobs;
+	size_t top = 0, bottom = 0;		// unsigned wrap-around keeps bottom - top equal to job count
+
+public:
+	JobQueue() { jobs.resize(JobQueueCapacity); }
+
+	bool Push(const Job& job) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (bottom - top == JobQueueCapacity) { return false; }
+		jobs[bottom++ % JobQueueCapacity] = job;
+		return true;
+	}
+	///<summary>
+	///Puts job back to the top, behind every other job of this queue
+	///</summary>
+	bool PushTop(const Job& job) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (bottom - top == JobQueueCapacity) { return false; }
+		jobs[--top % JobQueueCapacity] = job;
+		return true;
+	}
+	bool Pop(Job& job) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (bottom == top) { return false; }
+		job = jobs[--bottom % JobQueueCapacity];
+		return true;
+	}
+	bool Steal(Job& job) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (bottom == top) { return false; }
+		job = jobs[top++ % JobQueueCapacity];
+		return true;
+	}
+};
+
+///<summary>
+///Work-stealing scheduler. Thread, that created it, is worker 0 and runs jobs only while waiting; other workers are own threads.
+///Use the shared instance from Get(), so every subsystem scales over the same threads
+///</summary>
+class JobSystem {
+private:
+	std::vector<std::unique_ptr<JobQueue>> queues;
+	std::vector<std::thread> threads;
+	std::atomic<int> queuedJobs, sleepingWorkers;
+	std::atomic<bool> isStopping;
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	///<summary>
+	///Worker thread identity. A thread is worker of at most one system, for every other system it is an outside thread
+	///</summary>
+	typedef struct WorkerSlot {
+		const JobSystem* owner;
+		unsigned index;
+	} WorkerSlot;
+
+	static WorkerSlot& CurrentSlot(void) {
+		static thread_local WorkerSlot slot = { nullptr, 0 };
+		return slot;
+	}
+	///<summary>
+	///Index of the queue of calling thread. Threads, that are not workers of this system, including workers of other systems, share queue 0
+	///</summary>
+	unsigned CurrentWorker(void) const {
+		const WorkerSlot& slot = CurrentSlot();
+		return slot.owner == this ? slot.index : 0;
+	}
+
+	static void Execute(const Job& job) {
+		job.function(job.data, job.begin, job.end);
+		if (job.counter) { job.counter->pending.fetch_sub(1, std::memory_order_release); }
+	}
+	///<summary>
+	///Runs one job from own queue, or stolen from another. Job with unfinished dependency is put back behind the others.
+	///Returns false if no job was run
+	///</summary>
+	bool TryRunJob(void) {
+		const size_t queueSz = queues.size();
+		const unsigned self = CurrentWorker();
+		Job job;
+
+		bool isFound = queues[self]->Pop(job);
+		for (size_t i = 1; !isFound && i < queueSz; ++i) { isFound = queues[(self + i) % queueSz]->Steal(job); }
+		if (!isFound) { return false; }
+
+		if (job.dependency && !job.dependency->IsDone()) {
+			if (queues[self]->PushTop(job)) { return false; }
+			while (!job.dependency->IsDone()) { std::this_thread::yield(); }
+		}
+		--queuedJobs;
+		Execute(job);
+		return true;
+	}
+	void WorkerLoop(unsigned index) {
+		CurrentSlot().owner = this;
+		CurrentSlot().index = index;
+		while (!isStopping.load()) {
+			if (TryRunJob()) { continue; }
+			if (queuedJobs.load() > 0) { std::this_thread::yield(); continue; } // only jobs waiting for dependencies are left
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			++sleepingWorkers;
+			wakeUp.wait(lock, [this]() { return queuedJobs.load() > 0 || isStopping.load(); });
+			--sleepingWorkers;
+		}
+	}
+
+	template <typename Function>
+	static void ForEach(void* data, size_t begin, size_t end) {
+		Function& function = *(Function*)data;
+		for (size_t i = begin; i < end; ++i) { function(i); }
+	}
+
+public:
+	///<summary>
+	///Starts given amount of worker threads besides calling one. 0 takes one less than hardware threads
+	///</summary>
+	JobSystem(unsigned threadCount = 0) {
+		queuedJobs.store(0); sleepingWorkers.store(0); isStopping.store(false);
+		if (threadCount == 0) {
+			const unsigned hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+		}
+		for (unsigned i = 0; i <= threadCount; ++i) { queues.push_back(std::unique_ptr<JobQueue>(new JobQueue())); }
+		for (unsigned i = 1; i <= threadCount; ++i) { threads.push_back(std::thread(&JobSystem::WorkerLoop, this, i)); }
+	}
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			isStopping.store(true);
+		}
+		wakeUp.notify_all();
+		for (size_t i = 0; i < threads.size(); ++i) { threads[i].join(); }
+	}
+
+	///<summary>
+	///Returns scheduler shared by all subsystems. Created on first use
+	///</summary>
+	static JobSystem& Get(void) {
+		static JobSystem shared;
+		return shared;
+	}
+	///<summary>
+	///Returns amount of threads, that run jobs, including the one that waits
+	///</summary>
+	size_t GetWorkerCount(void) const { return queues.size(); }
+	///<summary>
+	///Returns true if calling thread is a worker thread started by any job system. Allocates nothing and creates no system
+	///</summary>
+	static bool IsWorkerThread(void) { return CurrentSlot().owner != nullptr; }
+
+	///<summary>
+	///Schedules function(data, begin, end). Counter is increased now and decreased when job finishes. Job starts after dependency is done
+	///</summary>
+	void Run(Job::Function function, void* data, size_t begin, size_t end, JobCounter& counter, const JobCounter* dependency = nullptr) {
+		Job job;
+		job.function = function; job.data = data; job.begin = begin; job.end = end;
+		job.counter = &counter; job.dependency = dependency;
+		counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+		if (!queues[CurrentWorker()]->Push(job)) {
+			//Queue is full: run here, helping with other jobs until dependency is done
+			if (dependency) { Wait(*dependency); }
+			Execute(job);
+			return;
+		}
+		++queuedJobs;
+		if (sleepingWorkers.load() > 0) {
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			wakeUp.notify_one();
+		}
+	}
+	///<summary>
+	///Returns when counter is done. Calling thread runs queued jobs meanwhile, so waiting inside a job can not deadlock
+	///</summary>
+	void Wait(const JobCounter& counter) {
+		while (!counter.IsDone()) {
+			if (!TryRunJob()) { std::this_thread::yield(); }
+		}
+	}
+	///<summary>
+	///Calls function(i) for i in [0; count) in parallel and returns after all calls. Range is split into batches of at least grain
+	///indices, a few per worker so stealing balances uneven work. Calling thread takes the first batch
+	///</summary>
+	template <typename Function>
+	void ParallelFor(size_t count, Function function, size_t grain = 1) {
+		const size_t maxBatches = queues.size() * 4;
+		size_t batches = (count + (grain ? grain : 1) - 1) / (grain ? grain : 1);
+		batches = batches < maxBatches ? batches : maxBatches;
+		if (batches <= 1 || queues.size() == 1) {
+			for (size_t i = 0; i < count; ++i) { function(i); }
+			return;
+		}
+
+		JobCounter counter;
+		for (size_t b = 1; b < batches; ++b) { Run(&ForEach<Function>, &function, count * b / batches, count * (b + 1) / batches, counter); }
+		ForEach<Function>(&function, 0, count / batches);
+		Wait(counter);
+	}
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/*
+  - Memory header
+  - Allocation tools for data, that lives only for a short time
+
+  - Memory.h:
+  - Contains realisations for AlignedMemory, AlignedAllocator, FrameArena
+*/
+
+///<summary>
+///Aligned heap memory of all AlignedAllocator types. Allocations are counted over all threads, so profiling sees memory, that bypasses operator new
+///</summary>
+class AlignedMemory {
+private:
+	static std::atomic<size_t>& Allocations(void) {
+		static std::atomic<size_t> allocations(0);
+		return allocations;
+	}
+
+public:
+	static void* Allocate(size_t size, size_t alignment) {
+		void* memory = nullptr;
+#ifdef _WIN32
+		memory = _aligned_malloc(size, alignment);
+#else
+		if (posix_memalign(&memory, alignment, size) != 0) { memory = nullptr; }
+#endif
+		if (!memory) { throw std::bad_alloc(); }
+		Allocations().fetch_add(1, std::memory_order_relaxed);
+		return memory;
+	}
+	static void Free(void* memory) {
+#ifdef _WIN32
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+	///<summary>
+	///Returns amount of aligned allocations made by all threads since program start
+	///</summary>
+	static size_t GetAllocationCount(void) { return Allocations().load(std::memory_order_relaxed); }
+};
+
+///<summary>
+///Allocator for std::vector, that aligns storage to given amount of bytes. Used for SIMD streams
+///</summary>
+template <typename T, size_t Alignment = 32>
+class AlignedAllocator {
+public:
+	typedef T value_type;
+
+	template <typename U>
+	struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+	AlignedAllocator() {}
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	T* allocate(size_t count) {
+		if (count == 0) { return nullptr; }
+		return (T*)AlignedMemory::Allocate(count * sizeof(T), Alignment);
+	}
+	void deallocate(T* memory, size_t) { AlignedMemory::Free(memory); }
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+///<summary>
+///Linear allocator for transient per-frame data. Memory is released all at once with Reset()
+///</summary>
+class FrameArena {
+private:
+	std::vector<unsigned char*> blocks;
+	std::vector<size_t> blockSizes;
+	size_t current, offset;
+	size_t frameAllocations, totalAllocations;
+
+	void AddBlock(size_t minSize) {
+		size_t size = blockSizes.empty() ? 65536 : blockSizes.back() * 2;
+		while (size < minSize) { size *= 2; }
+
+		unsigned char* block = (unsigned char*)std::malloc(size);
+		if (!block) { throw std::bad_alloc(); }
+
+		blocks.push_back(block);
+		blockSizes.push_back(size);
+		++frameAllocations;
+		++totalAllocations;
+	}
+	void Release(void) {
+		for (size_t i = 0; i < blocks.size(); ++i) { std::free(blocks[i]); }
+		blocks.clear();
+		blockSizes.clear();
+	}
+
+public:
+	FrameArena() { current = 0; offset = 0; frameAllocations = 0; totalAllocations = 0; }
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+	FrameArena(FrameArena&& other) noexcept { current = 0; offset = 0; frameAllocations = 0; totalAllocations = 0; *this = std::move(other); }
+	FrameArena& operator=(FrameArena&& other) noexcept {
+		if (this == &other) { return *this; }
+		Release();
+		blocks.swap(other.blocks);
+		blockSizes.swap(other.blockSizes);
+		current = other.current; offset = other.offset;
+		frameAllocations = other.frameAllocations; totalAllocations = other.totalAllocations;
+		other.current = 0; other.offset = 0;
+		return *this;
+	}
+	~FrameArena() { Release(); }
+
+	///<summary>
+	///Returns uninitialised memory for given amount of bytes. Valid until next Reset()
+	///</summary>
+	void* Allocate(size_t size, size_t alignment = 16) {
+		while (current < blocks.size()) {
+			size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+			if (aligned + size <= blockSizes[current]) {
+				offset = aligned + size;
+				return blocks[current] + aligned;
+			}
+			++current;
+			offset = 0;
+		}
+		AddBlock(size + alignment);
+		current = blocks.size() - 1;
+		offset = 0;
+		return Allocate(size, alignment);
+	}
+	///<summary>
+	///Returns uninitialised array of given amount of elements. Valid until next Reset()
+	///</summary>
+	template <typename T>
+	T* Allocate(size_t count) { return (T*)Allocate(count * sizeof(T), alignof(T) > 16 ? alignof(T) : 16); }
+	///<summary>
+	///Frees everything allocated since last reset. If frame needed several blocks, they are merged into one, so next frames need no heap allocations.
+	///The merge allocation is counted in the frame, that starts with this reset
+	///</summary>
+	void Reset(void) {
+		frameAllocations = 0;
+		if (blocks.size() > 1) {
+			size_t total = 0;
+			for (size_t i = 0; i < blockSizes.size(); ++i) { total += blockSizes[i]; }
+			Release();
+			AddBlock(total);
+		}
+		current = 0;
+		offset = 0;
+	}
+	///<summary>
+	///Returns amount of heap allocations done by this arena since last Reset()
+	///</summary>
+	size_t GetFrameAllocations(void) const { return frameAllocations; }
+	///<summary>
+	///Returns amount of heap allocations done by this arena during its lifetime
+	///</summary>
+	size_t GetTotalAllocations(void) const { return totalAllocations; }
+	///<summary>
+	///Returns total reserved capacity in bytes
+	///</summary>
+	size_t GetCapacity(void) const {
+		size_t total = 0;
+		for (size_t i = 0; i < blockSizes.size(); ++i) { total += blockSizes[i]; }
+		return total;
+	}
+};
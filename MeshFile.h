@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Platform.h"
+#include "Geometry.h"
+#include "Graphics.h"
+
+/*
+  - Binary mesh file header
+  - Stores meshes with vertex streams, index stream, bounds and normals in a versioned, aligned file.
+    Files are loaded by memory mapping: MeshView streams point straight into mapped pages, nothing is parsed or copied
+
+  - MeshFile.h:
+  - Contains realisations for MeshFileHeader, MeshFileRecord, MeshFile
+
+  - Layout (host byte order, little-endian on every supported platform):
+  - MeshFileHeader, then MeshFileRecord per mesh, then streams. Each stream starts at MeshFileAlignment boundary,
+    record stores stream offsets from file start
+
+  - Dependencies:
+  - Platform.h
+  - Geometry.h
+  - Graphics.h
+*/
+
+#define MeshFileMagic		0x4853454Du		// "MESH"
+#define MeshFileVersion		1
+#define MeshFileAlignment	64				// cache line; stays aligned for 32-byte SIMD loads from mapped pages
+
+typedef struct MeshFileHeader {
+	unsigned magic;
+	unsigned version;
+	unsigned meshCount;
+	unsigned reserved;
+} MeshFileHeader;
+
+typedef struct MeshFileRecord {
+	///<summary>
+	///Streams of one mesh in file order
+	///</summary>
+	enum Stream {
+		positionX, positionY, positionZ,
+		faceNormalX, faceNormalY, faceNormalZ,
+		vertexNormalX, vertexNormalY, vertexNormalZ,
+		triangleIndices,
+		streamCount
+	};
+
+	unsigned long long vertexCount;
+	unsigned long long indexCount;
+	float boxMin[3], boxMax[3];
+	float sphereCenter[3], sphereRadius;
+	unsigned long long streams[streamCount];
+
+	///<summary>
+	///Returns amount of 4-byte elements in given stream
+	///</summary>
+	unsigned long long GetStreamLength(int stream) const {
+		if (stream == triangleIndices) { return indexCount; }
+		if (stream >= faceNormalX && stream <= faceNormalZ) { return indexCount / 3; }
+		return vertexCount;
+	}
+} MeshFileRecord;
+
+///<summary>
+///Memory-mapped mesh file. Views returned by GetMesh() point into the mapping and stay valid until Close() or destruction
+///</summary>
+class MeshFile {
+private:
+	MappedFile file;
+	std::vector<MeshView> meshes;
+
+	static size_t Align(size_t offset) { return (offset + MeshFileAlignment - 1) / MeshFileAlignment * MeshFileAlignment; }
+
+	static bool WriteStream(FILE* output, size_t& offset, const void* data, size_t size) {
+		static const unsigned char padding[MeshFileAlignment] = { 0 };
+		const size_t aligned = Align(offset);
+		if (aligned > offset && fwrite(padding, 1, aligned - offset, output) != aligned - offset) { return false; }
+		offset = aligned + size;
+		return size == 0 || fwrite(data, 1, size, output) == size;
+	}
+
+public:
+	MeshFile() {}
+
+	///<summary>
+	///Maps file and checks its header and every stream range. Returns false if file is missing, has other version or is truncated.
+	///Index values are checked only with checkIndices, which reads every index page. Renderer::UploadMesh() checks them in any case,
+	///other users of unchecked views have to call MeshView::HasValidIndices()
+	///</summary>
+	bool Open(const char* path, bool checkIndices = false) {
+		Close();
+		if (!file.Open(path)) { return false; }
+
+		const unsigned char* data = file.GetData();
+		const size_t size = file.GetSize();
+		if (size < sizeof(MeshFileHeader)) { Close(); return false; }
+
+		const MeshFileHeader* header = (const MeshFileHeader*)data;
+		if (header->magic != MeshFileMagic || header->version != MeshFileVersion) { Close(); return false; }
+		if ((size - sizeof(MeshFileHeader)) / sizeof(MeshFileRecord) < header->meshCount) { Close(); return false; }
+
+		const MeshFileRecord* records = (const MeshFileRecord*)(data + sizeof(MeshFileHeader));
+		meshes.resize(header->meshCount);
+
+		for (unsigned m = 0; m < header->meshCount; ++m) {
+			const MeshFileRecord& record = records[m];
+			const unsigned long long faceCount = record.indexCount / 3;
+
+			for (int stream = 0; stream < MeshFileRecord::streamCount; ++stream) {
+				const unsigned long long count = record.GetStreamLength(stream);
+				const unsigned long long offset = record.streams[stream];
+				if (offset % MeshFileAlignment != 0 || offset > size || count > (size - offset) / 4) { Close(); return false; }
+			}
+
+			MeshView& view = meshes[m];
+			view.x = (const float*)(data + record.streams[MeshFileRecord::positionX]);
+			view.y = (const float*)(data + record.streams[MeshFileRecord::positionY]);
+			view.z = (const float*)(data + record.streams[MeshFileRecord::positionZ]);
+			view.faceNormalX = (const float*)(data + record.streams[MeshFileRecord::faceNormalX]);
+			view.faceNormalY = (const float*)(data + record.streams[MeshFileRecord::faceNormalY]);
+			view.faceNormalZ = (const float*)(data + record.streams[MeshFileRecord::faceNormalZ]);
+			view.vertexNormalX = (const float*)(data + record.streams[MeshFileRecord::vertexNormalX]);
+			view.vertexNormalY = (const float*)(data + record.streams[MeshFileRecord::vertexNormalY]);
+			view.vertexNormalZ = (const float*)(data + record.streams[MeshFileRecord::vertexNormalZ]);
+			view.triangles = (const unsigned*)(data + record.streams[MeshFileRecord::triangleIndices]);
+			view.vertexCount = (size_t)record.vertexCount;
+			view.indexCount = (size_t)(faceCount * 3);
+			view.boundingBox = BoundingBox(Vector3(record.boxMin[0], record.boxMin[1], record.boxMin[2]), Vector3(record.boxMax[0], record.boxMax[1], record.boxMax[2]));
+			view.boundingSphere = BoundingSphere(Vector3(record.sphereCenter[0], record.sphereCenter[1], record.sphereCenter[2]), record.sphereRadius);
+			if (checkIndices && !view.HasValidIndices()) { Close(); return false; }
+		}
+		return true;
+	}
+	void Close(void) { meshes.clear(); file.Close(); }
+
+	bool IsOpen(void) const { return file.IsOpen(); }
+	size_t GetMeshCount(void) const { return meshes.size(); }
+	const MeshView& GetMesh(size_t index) const { return meshes[index]; }
+
+	///<summary>
+	///Writes meshes with their cached normals and bounds. Returns false if file can not be written
+	///</summary>
+	static bool Write(const char* path, const std::vector<const Mesh*>& meshList) {
+		FILE* output = fopen(path, "wb");
+		if (!output) { return false; }
+
+		MeshFileHeader header;
+		header.magic = MeshFileMagic;
+		header.version = MeshFileVersion;
+		header.meshCount = (unsigned)meshList.size();
+		header.reserved = 0;
+
+		//Records are filled with offsets first, streams follow in the same order
+		std::vector<MeshFileRecord> records(meshList.size());
+		std::vector<MeshView> views;
+		views.reserve(meshList.size());
+		size_t offset = sizeof(MeshFileHeader) + records.size() * sizeof(MeshFileRecord);
+
+		for (size_t m = 0; m < meshList.size(); ++m) {
+			views.push_back(MeshView(*meshList[m]));
+			const MeshView& view = views.back();
+			MeshFileRecord& record = records[m];
+			memset(&record, 0, sizeof(MeshFileRecord));
+
+			record.vertexCount = view.vertexCount;
+			record.indexCount = view.indexCount;
+			record.boxMin[0] = view.boundingBox.min.x; record.boxMin[1] = view.boundingBox.min.y; record.boxMin[2] = view.boundingBox.min.z;
+			record.boxMax[0] = view.boundingBox.max.x; record.boxMax[1] = view.boundingBox.max.y; record.boxMax[2] = view.boundingBox.max.z;
+			record.sphereCenter[0] = view.boundingSphere.center.x; record.sphereCenter[1] = view.boundingSphere.center.y; record.sphereCenter[2] = view.boundingSphere.center.z;
+			record.sphereRadius = view.boundingSphere.radius;
+
+			for (int stream = 0; stream < MeshFileRecord::streamCount; ++stream) {
+				offset = Align(offset);
+				record.streams[stream] = offset;
+				offset += (size_t)record.GetStreamLength(stream) * 4;
+			}
+		}
+
+		bool isWritten = fwrite(&header, sizeof(MeshFileHeader), 1, output) == 1;
+		if (!records.empty()) { isWritten = isWritten && fwrite(records.data(), sizeof(MeshFileRecord), records.size(), output) == records.size(); }
+
+		offset = sizeof(MeshFileHeader) + records.size() * sizeof(MeshFileRecord);
+		for (size_t m = 0; m < views.size() && isWritten; ++m) {
+			const MeshView& view = views[m];
+			const void* streams[MeshFileRecord::streamCount] = {
+				view.x, view.y, view.z,
+				view.faceNormalX, view.faceNormalY, view.faceNormalZ,
+				view.vertexNormalX, view.vertexNormalY, view.vertexNormalZ,
+				view.triangles
+			};
+			for (int stream = 0; stream < MeshFileRecord::streamCount && isWritten; ++stream) {
+				isWritten = WriteStream(output, offset, streams[stream], (size_t)records[m].GetStreamLength(stream) * 4);
+			}
+		}
+		return fclose(output) == 0 && isWritten;
+	}
+	static bool Write(const char* path, const Mesh& mesh) { return Write(path, std::vector<const Mesh*>(1, &mesh)); }
+};
@@ -0,0 +1,571 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Geometry.h"
+#include "Graphics.h"
+#include "MeshOptimizer.h"
+#include "Jobs.h"
+
+/*
+  - Mesh import header
+  - Reads Wavefront OBJ and binary PLY files into Mesh. Files are streamed in fixed size blocks, every block is split
+    into chunks, that are parsed by job system workers straight into their place in the result
+
+  - MeshImporter.h:
+  - Contains realisations for MeshImporter
+
+  - Dependencies:
+  - Geometry.h
+  - Graphics.h
+  - MeshOptimizer.h
+  - Jobs.h
+*/
+
+///<summary>
+///Streaming parallel mesh importer. Memory used besides the result is bounded by block size, whatever the file size.
+///Only positions and faces are read, polygons are triangulated as fans
+///</summary>
+class MeshImporter {
+private:
+	///<summary>
+	///Bytes read from file at once. Lines and records never cross block boundaries: incomplete tail is carried to the next block
+	///</summary>
+	static const size_t BlockSize = 8 << 20;
+	///<summary>
+	///Largest accepted amount of items in one PLY list. Bigger or negative counts mark file invalid
+	///</summary>
+	static const size_t MaxPlyListCount = 1 << 20;
+	///<summary>
+	///PlyRecordSize() result for record with invalid list count
+	///</summary>
+	static const size_t InvalidPlyRecord = ~(size_t)0;
+
+	///<summary>
+	///Amount of vertices and triangles in one chunk of OBJ text
+	///</summary>
+	typedef struct ChunkCounts {
+		size_t vertices, triangles;
+
+		ChunkCounts() { vertices = 0; triangles = 0; }
+	} ChunkCounts;
+
+	///<summary>
+	///Destination of parsed OBJ chunk. Null streams only count
+	///</summary>
+	typedef struct ObjTarget {
+		float *x, *y, *z;
+		unsigned* triangles;
+		size_t vertexBase, vertexCount;
+		std::atomic<bool>* isValid;
+
+		ObjTarget() { x = y = z = nullptr; triangles = nullptr; vertexBase = 0; vertexCount = 0; isValid = nullptr; }
+	} ObjTarget;
+
+	static size_t ChunksPerBlock(void) { return JobSystem::Get().GetWorkerCount() * 2; }
+
+	static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+	static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+	static double Pow10(int exponent) {
+		static const double table[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		double result = 1;
+		for (; exponent > 22; exponent -= 22) { result *= 1e22; }
+		return result * table[exponent];
+	}
+	///<summary>
+	///Parses decimal float with optional sign, fraction and exponent. Up to 19 significant digits are kept in integer mantissa,
+	///which is scaled by exact power of ten once. Returns position after the number, or p itself if there is no number
+	///</summary>
+	static const char* ParseFloat(const char* p, const char* end, float& value) {
+		const char* start = p;
+		const bool isNegative = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+')) { ++p; }
+
+		unsigned long long mantissa = 0;
+		int exponent = 0, digits = 0;
+		bool hasDigits = false;
+		for (; p < end && IsDigit(*p); ++p) {
+			hasDigits = true;
+			if (digits < 19) { mantissa = mantissa * 10 + (unsigned)(*p - '0'); digits += mantissa != 0; }
+			else { ++exponent; }
+		}
+		if (p < end && *p == '.') {
+			for (++p; p < end && IsDigit(*p); ++p) {
+				hasDigits = true;
+				if (digits < 19) { mantissa = mantissa * 10 + (unsigned)(*p - '0'); digits += mantissa != 0; --exponent; }
+			}
+		}
+		if (!hasDigits) { return start; }
+
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* exponentStart = p++;
+			const bool isExponentNegative = p < end && *p == '-';
+			if (p < end && (*p == '-' || *p == '+')) { ++p; }
+			if (p < end && IsDigit(*p)) {
+				int value = 0;
+				for (; p < end && IsDigit(*p); ++p) { value = value < 10000 ? value * 10 + (*p - '0') : value; }
+				exponent += isExponentNegative ? -value : value;
+			}
+			else { p = exponentStart; }
+		}
+
+		double result = (double)mantissa;
+		if (exponent < -300) { result = 0; }
+		else if (exponent < 0) { result /= Pow10(-exponent); }
+		else if (exponent > 0) { result *= Pow10(exponent < 400 ? exponent : 400); }
+		value = (float)(isNegative ? -result : result);
+		return p;
+	}
+	static const char* ParseInt(const char* p, const char* end, long long& value) {
+		const char* start = p;
+		const bool isNegative = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+')) { ++p; }
+		if (p >= end || !IsDigit(*p)) { return start; }
+
+		long long result = 0;
+		for (; p < end && IsDigit(*p); ++p) { result = result < 1000000000000LL ? result * 10 + (*p - '0') : result; }
+		value = isNegative ? -result : result;
+		return p;
+	}
+
+	///<summary>
+	///Reads file in blocks and splits each block into chunks of whole lines. Calls onBlock(firstChunk, chunkCount) on this thread,
+	///then onChunk(chunk, begin, end) for the chunks in parallel. Chunk numbers continue across blocks, splitting is the same on every run
+	///</summary>
+	template <typename BlockFunction, typename ChunkFunction>
+	static bool StreamLines(FILE* file, BlockFunction onBlock, ChunkFunction onChunk) {
+		std::vector<char> buffer(BlockSize);
+		std::vector<const char*> bounds;
+		const size_t chunksPerBlock = ChunksPerBlock();
+		size_t carried = 0, chunkCount = 0;
+
+		for (;;) {
+			if (carried == buffer.size()) { buffer.resize(buffer.size() * 2); } // single line longer than buffer
+			const size_t read = fread(buffer.data() + carried, 1, buffer.size() - carried, file);
+			const bool isLast = read < buffer.size() - carried;
+			const size_t size = carried + read;
+			if (isLast && ferror(file)) { return false; }
+
+			//Everything after the last line break waits for the next block, last block is taken whole
+			size_t used = size;
+			if (!isLast) {
+				while (used > 0 && buffer[used - 1] != '\n') { --used; }
+				if (used == 0) { carried = size; continue; }
+			}
+
+			const char* data = buffer.data();
+			bounds.assign(1, data);
+			for (size_t c = 1; c < chunksPerBlock; ++c) {
+				const char* split = data + used * c / chunksPerBlock;
+				if (split <= bounds.back()) { continue; }
+				const char* lineEnd = (const char*)memchr(split, '\n', data + used - split);
+				if (!lineEnd || lineEnd + 1 >= data + used) { break; }
+				if (lineEnd + 1 > bounds.back()) { bounds.push_back(lineEnd + 1); }
+			}
+			bounds.push_back(data + used);
+
+			const size_t blockChunks = bounds.size() - 1;
+			onBlock(chunkCount, blockChunks);
+			JobSystem::Get().ParallelFor(blockChunks, [&](size_t i) { onChunk(chunkCount + i, bounds[i], bounds[i + 1]); });
+			chunkCount += blockChunks;
+
+			if (isLast) { return true; }
+			carried = size - used;
+			memmove(buffer.data(), buffer.data() + used, carried);
+		}
+	}
+	///<summary>
+	///Parses OBJ lines: "v x y z" and "f a b c ...", where each face index may be followed by /texture/normal indices.
+	///Counts vertices and triangles, and writes them if target has streams
+	///</summary>
+	static ChunkCounts ParseObjChunk(const char* p, const char* end, const ObjTarget& target) {
+		ChunkCounts counts;
+		const bool isWriting = target.x != nullptr;
+
+		while (p < end) {
+			while (p < end && IsSpace(*p)) { ++p; }
+			const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+			if (!lineEnd) { lineEnd = end; }
+
+			if (lineEnd - p > 1 && p[0] == 'v' && IsSpace(p[1])) {
+				if (isWriting) {
+					float coordinates[3] = { 0, 0, 0 };
+					const char* q = p + 2;
+					for (int k = 0; k < 3; ++k) {
+						while (q < lineEnd && IsSpace(*q)) { ++q; }
+						const char* next = ParseFloat(q, lineEnd, coordinates[k]);
+						if (next == q) { target.isValid->store(false); break; }
+						q = next;
+					}
+					const size_t v = target.vertexBase + counts.vertices;
+					target.x[v] = coordinates[0]; target.y[v] = coordinates[1]; target.z[v] = coordinates[2];
+				}
+				++counts.vertices;
+			}
+			else if (lineEnd - p > 1 && p[0] == 'f' && IsSpace(p[1])) {
+				//Polygon a b c d ... becomes fan (a b c) (a c d) ...
+				unsigned first = 0, previous = 0;
+				size_t corners = 0;
+				const char* q = p + 2;
+
+				for (;;) {
+					while (q < lineEnd && IsSpace(*q)) { ++q; }
+					long long index = 0;
+					const char* next = ParseInt(q, lineEnd, index);
+					if (next == q) { break; }
+					q = next;
+					while (q < lineEnd && !IsSpace(*q)) { ++q; }
+
+					//Negative index counts back from the last vertex read before this line
+					const long long resolved = index > 0 ? index - 1 : (long long)(target.vertexBase + counts.vertices) + index;
+					if (isWriting && (index == 0 || resolved < 0 || resolved >= (long long)target.vertexCount)) { target.isValid->store(false); }
+					const unsigned current = (unsigned)resolved;
+
+					if (corners == 0) { first = current; }
+					else if (corners >= 2) {
+						if (isWriting) {
+							unsigned* triangle = &target.triangles[counts.triangles * 3];
+							triangle[0] = first; triangle[1] = previous; triangle[2] = current;
+						}
+						++counts.triangles;
+					}
+					previous = current;
+					++corners;
+				}
+			}
+			p = lineEnd + 1;
+		}
+		return counts;
+	}
+
+	///<summary>
+	///Scalar property of PLY element. List properties have count type and item type
+	///</summary>
+	typedef struct PlyProperty {
+		std::string name;
+		int type, countType;
+		bool isList;
+	} PlyProperty;
+	typedef struct PlyElement {
+		std::string name;
+		size_t count;
+		std::vector<PlyProperty> properties;
+	} PlyElement;
+
+	///<summary>
+	///Returns size in bytes of PLY type name, 0 if unknown
+	///</summary>
+	static int PlyTypeSize(const std::string& type) {
+		if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") { return 1; }
+		if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") { return 2; }
+		if (type == "int" || type == "uint" || type == "int32" || type == "uint32" || type == "float" || type == "float32") { return 4; }
+		if (type == "double" || type == "float64") { return 8; }
+		return 0;
+	}
+	///<summary>
+	///PLY types are encoded as size, negated for signed integers and multiplied by 10 for floating point
+	///</summary>
+	static int PlyType(const std::string& type) {
+		const int size = PlyTypeSize(type);
+		if (type == "float" || type == "float32" || type == "double" || type == "float64") { return size * 10; }
+		if (type[0] != 'u') { return -size; }
+		return size;
+	}
+	static int PlySize(int type) { return type < 0 ? -type : type >= 10 ? type / 10 : type; }
+	static double ReadPly(const unsigned char* p, int type, bool isBigEndian) {
+		unsigned char bytes[8] = { 0 };
+		const int size = PlySize(type);
+		for (int i = 0; i < size; ++i) { bytes[i] = isBigEndian ? p[size - 1 - i] : p[i]; }
+
+		switch (type) {
+		case 1: return bytes[0];
+		case -1: return (signed char)bytes[0];
+		case 2: { unsigned short v; memcpy(&v, bytes, 2); return v; }
+		case -2: { short v; memcpy(&v, bytes, 2); return v; }
+		case 4: { unsigned v; memcpy(&v, bytes, 4); return v; }
+		case -4: { int v; memcpy(&v, bytes, 4); return v; }
+		case 40: { float v; memcpy(&v, bytes, 4); return v; }
+		default: { double v; memcpy(&v, bytes, 8); return v; }
+		}
+	}
+	///<summary>
+	///Reads list item count, header allows only integer types. Returns InvalidPlyRecord if it is negative or above MaxPlyListCount
+	///</summary>
+	static size_t ReadPlyCount(const unsigned char* p, int type, bool isBigEndian) {
+		const double count = ReadPly(p, type, isBigEndian);
+		if (count < 0 || count > MaxPlyListCount) { return InvalidPlyRecord; }
+		return (size_t)count;
+	}
+	///<summary>
+	///Returns size of record starting at p, 0 if it does not fit before end, or InvalidPlyRecord if a list count is invalid
+	///</summary>
+	static size_t PlyRecordSize(const PlyElement& element, const unsigned char* p, const unsigned char* end, bool isBigEndian) {
+		size_t size = 0;
+		for (size_t i = 0; i < element.properties.size(); ++i) {
+			const PlyProperty& property = element.properties[i];
+			if (!property.isList) { size += PlySize(property.type); continue; }
+
+			if ((size_t)(end - p) < size + PlySize(property.countType)) { return 0; }
+			const size_t count = ReadPlyCount(p + size, property.countType, isBigEndian);
+			if (count == InvalidPlyRecord) { return InvalidPlyRecord; }
+			size += PlySize(property.countType) + count * PlySize(property.type);
+		}
+		return (size_t)(end - p) >= size ? size : 0;
+	}
+	static bool ReadPlyHeader(FILE* file, std::vector<PlyElement>& elements, bool& isBigEndian) {
+		char line[1024];
+		if (!fgets(line, sizeof(line), file) || strncmp(line, "ply", 3) != 0) { return false; }
+
+		bool hasFormat = false;
+		while (fgets(line, sizeof(line), file)) {
+			char word[64] = { 0 }, a[64] = { 0 }, b[64] = { 0 }, c[64] = { 0 }, d[64] = { 0 };
+			const int words = sscanf(line, "%63s %63s %63s %63s %63s", word, a, b, c, d);
+			if (words <= 0) { continue; }
+
+			if (!strcmp(word, "end_header")) { return hasFormat; }
+			if (!strcmp(word, "format") && words >= 2) {
+				if (!strcmp(a, "binary_little_endian")) { isBigEndian = false; }
+				else if (!strcmp(a, "binary_big_endian")) { isBigEndian = true; }
+				else { return false; } // ascii PLY is not supported
+				hasFormat = true;
+			}
+			else if (!strcmp(word, "element") && words >= 3) {
+				PlyElement element;
+				element.name = a;
+				element.count = (size_t)strtoull(b, nullptr, 10);
+				elements.push_back(element);
+			}
+			else if (!strcmp(word, "property") && words >= 3 && !elements.empty()) {
+				PlyProperty property;
+				property.isList = !strcmp(a, "list");
+				if (property.isList && words < 5) { return false; }
+				property.countType = property.isList ? PlyType(b) : 0;
+				property.type = PlyType(property.isList ? c : a);
+				property.name = property.isList ? d : b;
+				if (property.type == 0 || (property.isList && (property.countType == 0 || property.countType >= 10))) { return false; }
+				elements.back().properties.push_back(property);
+			}
+		}
+		return false;
+	}
+	///<summary>
+	///Streams records of one PLY element. Calls onRecords(records, offsets, count) for every block of whole records on this thread
+	///</summary>
+	template <typename Function>
+	static bool StreamPlyRecords(FILE* file, const PlyElement& element, bool isBigEndian, Function onRecords) {
+		std::vector<unsigned char> buffer(BlockSize);
+		std::vector<size_t> offsets;
+		size_t carried = 0, remaining = element.count;
+
+		while (remaining > 0) {
+			if (carried == buffer.size()) { buffer.resize(buffer.size() * 2); }
+			const size_t read = fread(buffer.data() + carried, 1, buffer.size() - carried, file);
+			const size_t size = carried + read;
+			if (read == 0) { return false; }
+
+			offsets.clear();
+			size_t offset = 0;
+			while (offsets.size() < remaining) {
+				const size_t recordSize = PlyRecordSize(element, buffer.data() + offset, buffer.data() + size, isBigEndian);
+				if (recordSize == InvalidPlyRecord) { return false; }
+				if (recordSize == 0) { break; }
+				offsets.push_back(offset);
+				offset += recordSize;
+			}
+			offsets.push_back(offset);
+
+			const size_t count = offsets.size() - 1;
+			if (count > 0) { onRecords(buffer.data(), offsets, count); }
+			remaining -= count;
+
+			//Bytes after the last whole record belong to the next one, or to the next element when this one is finished
+			carried = size - offset;
+			if (remaining == 0) { return fseek(file, -(long)carried, SEEK_CUR) == 0; }
+			memmove(buffer.data(), buffer.data() + offset, carried);
+		}
+		return true;
+	}
+
+public:
+	///<summary>
+	///Imports Wavefront OBJ. File is read twice: first pass counts vertices and triangles of every chunk, so the mesh is allocated once
+	///with exact sizes, second pass parses chunks in parallel straight into their place. Returns false if file can not be read or indices are invalid
+	///</summary>
+	static bool ImportObj(const char* path, Mesh& mesh, bool weld = true) {
+		FILE* file = fopen(path, "rb");
+		if (!file) { return false; }
+
+		std::vector<ChunkCounts> counts;
+		const ObjTarget countOnly;
+		bool isRead = StreamLines(file, [&](size_t first, size_t chunkCount) { counts.resize(first + chunkCount); },
+			[&](size_t chunk, const char* begin, const char* end) { counts[chunk] = ParseObjChunk(begin, end, countOnly); });
+
+		//Chunk offsets in the result
+		std::vector<ChunkCounts> offsets(counts.size());
+		ChunkCounts total;
+		for (size_t i = 0; i < counts.size(); ++i) {
+			offsets[i] = total;
+			total.vertices += counts[i].vertices;
+			total.triangles += counts[i].triangles;
+		}
+
+		mesh.Clear();
+		mesh.vertices.resize(total.vertices);
+		mesh.triangles.resize(total.triangles * 3);
+		float* x = mesh.vertices.GetX();
+		float* y = mesh.vertices.GetY();
+		float* z = mesh.vertices.GetZ();
+		std::atomic<bool> isValid(true);
+
+		if (isRead) {
+			rewind(file);
+			isRead = StreamLines(file, [](size_t, size_t) {}, [&](size_t chunk, const char* begin, const char* end) {
+				if (chunk >= offsets.size()) { isValid.store(false); return; }
+				ObjTarget target;
+				target.x = x; target.y = y; target.z = z;
+				target.triangles = mesh.triangles.data() + offsets[chunk].triangles * 3;
+				target.vertexBase = offsets[chunk].vertices;
+				target.vertexCount = total.vertices;
+				target.isValid = &isValid;
+				ParseObjChunk(begin, end, target);
+			});
+		}
+		fclose(file);
+
+		if (!isRead || !isValid.load()) { mesh.Clear(); return false; }
+		if (weld) { MeshOptimizer::Weld(mesh, 0); }
+		else { mesh.RecalculateNormals(); }
+		return true;
+	}
+	///<summary>
+	///Imports binary PLY with "vertex" element (x, y, z of any scalar type) and "face" element (list "vertex_indices" or "vertex_index").
+	///Vertices are allocated once from header count, triangle storage is reserved for triangulated faces and grows only for polygons.
+	///Blocks of records are decoded in parallel. Returns false for ascii PLY, unreadable file or invalid indices
+	///</summary>
+	static bool ImportPly(const char* path, Mesh& mesh, bool weld = true) {
+		FILE* file = fopen(path, "rb");
+		if (!file) { return false; }
+
+		std::vector<PlyElement> elements;
+		bool isBigEndian = false;
+		if (!ReadPlyHeader(file, elements, isBigEndian)) { fclose(file); return false; }
+
+		mesh.Clear();
+		size_t vertexCount = 0;
+		for (size_t e = 0; e < elements.size(); ++e) {
+			if (elements[e].name == "vertex") { vertexCount = elements[e].count; }
+			if (elements[e].name == "face") { mesh.triangles.reserve(elements[e].count * 3); }
+		}
+		mesh.vertices.resize(vertexCount);
+		float* x = mesh.vertices.GetX();
+		float* y = mesh.vertices.GetY();
+		float* z = mesh.vertices.GetZ();
+		std::atomic<bool> isValid(true);
+		bool isRead = true;
+
+		for (size_t e = 0; e < elements.size() && isRead; ++e) {
+			const PlyElement& element = elements[e];
+			const size_t propertySz = element.properties.size();
+
+			if (element.name == "vertex") {
+				//Offsets of x, y, z in record. They must come before any list property, so their offsets are fixed
+				int coordinateOffsets[3] = { -1, -1, -1 }, coordinateTypes[3] = { 0, 0, 0 };
+				int offset = 0;
+				for (size_t i = 0; i < propertySz && !element.properties[i].isList; ++i) {
+					const PlyProperty& property = element.properties[i];
+					const int axis = property.name == "x" ? 0 : property.name == "y" ? 1 : property.name == "z" ? 2 : -1;
+					if (axis >= 0) { coordinateOffsets[axis] = offset; coordinateTypes[axis] = property.type; }
+					offset += PlySize(property.type);
+				}
+				if (coordinateOffsets[0] < 0 || coordinateOffsets[1] < 0 || coordinateOffsets[2] < 0) { isRead = false; break; }
+
+				size_t vertexBase = 0;
+				isRead = StreamPlyRecords(file, element, isBigEndian, [&](const unsigned char* records, const std::vector<size_t>& offsets, size_t count) {
+					const size_t chunkCount = std::min(count, ChunksPerBlock());
+					JobSystem::Get().ParallelFor(chunkCount, [&](size_t chunk) {
+						for (size_t r = count * chunk / chunkCount; r < count * (chunk + 1) / chunkCount; ++r) {
+							const unsigned char* record = records + offsets[r];
+							const size_t v = vertexBase + r;
+							x[v] = (float)ReadPly(record + coordinateOffsets[0], coordinateTypes[0], isBigEndian);
+							y[v] = (float)ReadPly(record + coordinateOffsets[1], coordinateTypes[1], isBigEndian);
+							z[v] = (float)ReadPly(record + coordinateOffsets[2], coordinateTypes[2], isBigEndian);
+						}
+					});
+					vertexBase += count;
+				});
+			}
+			else if (element.name == "face") {
+				size_t indexProperty = propertySz;
+				for (size_t i = 0; i < propertySz; ++i) {
+					const PlyProperty& property = element.properties[i];
+					if (property.isList && (property.name == "vertex_indices" || property.name == "vertex_index")) { indexProperty = i; break; }
+				}
+				if (indexProperty == propertySz) { isRead = false; break; }
+
+				std::vector<size_t> listOffsets, triangleOffsets;
+				isRead = StreamPlyRecords(file, element, isBigEndian, [&](const unsigned char* records, const std::vector<size_t>& offsets, size_t count) {
+					//Position of index list and first triangle of every record, then fan triangulation in parallel
+					const PlyProperty& property = element.properties[indexProperty];
+					listOffsets.resize(count);
+					triangleOffsets.resize(count + 1);
+					size_t triangles = mesh.triangles.size() / 3;
+					for (size_t r = 0; r < count; ++r) {
+						size_t offset = offsets[r];
+						for (size_t i = 0; i < indexProperty; ++i) {
+							const PlyProperty& skipped = element.properties[i];
+							offset += skipped.isList ? PlySize(skipped.countType) + ReadPlyCount(records + offset, skipped.countType, isBigEndian) * PlySize(skipped.type) : PlySize(skipped.type);
+						}
+						listOffsets[r] = offset;
+						triangleOffsets[r] = triangles;
+						const size_t corners = ReadPlyCount(records + offset, property.countType, isBigEndian);	// checked by PlyRecordSize()
+						triangles += corners > 2 ? corners - 2 : 0;
+					}
+					triangleOffsets[count] = triangles;
+					mesh.triangles.resize(triangles * 3);
+
+					unsigned* indices = mesh.triangles.data();
+					const int countSize = PlySize(property.countType), indexSize = PlySize(property.type);
+					const size_t chunkCount = std::min(count, ChunksPerBlock());
+					JobSystem::Get().ParallelFor(chunkCount, [&](size_t chunk) {
+						for (size_t r = count * chunk / chunkCount; r < count * (chunk + 1) / chunkCount; ++r) {
+							const unsigned char* list = records + listOffsets[r] + countSize;
+							unsigned* triangle = indices + triangleOffsets[r] * 3;
+							const size_t triangleCount = triangleOffsets[r + 1] - triangleOffsets[r];
+							const double first = ReadPly(list, property.type, isBigEndian);
+
+							for (size_t t = 0; t < triangleCount; ++t, triangle += 3) {
+								const double second = ReadPly(list + (t + 1) * indexSize, property.type, isBigEndian);
+								const double third = ReadPly(list + (t + 2) * indexSize, property.type, isBigEndian);
+								if (first < 0 || second < 0 || third < 0 || first >= vertexCount || second >= vertexCount || third >= vertexCount) { isValid.store(false); }
+								triangle[0] = (unsigned)first; triangle[1] = (unsigned)second; triangle[2] = (unsigned)third;
+							}
+						}
+					});
+				});
+			}
+			else {
+				isRead = StreamPlyRecords(file, element, isBigEndian, [](const unsigned char*, const std::vector<size_t>&, size_t) {});
+			}
+		}
+		fclose(file);
+
+		if (!isRead || !isValid.load()) { mesh.Clear(); return false; }
+		if (weld) { MeshOptimizer::Weld(mesh, 0); }
+		else { mesh.RecalculateNormals(); }
+		return true;
+	}
+	///<summary>
+	///Imports OBJ or PLY file, chosen by extension. Exactly equal vertices are merged and degenerate faces removed if weld is set
+	///</summary>
+	static bool Import(const char* path, Mesh& mesh, bool weld = true) {
+		const char* extension = strrchr(path, '.');
+		if (!extension) { return false; }
+		if (!strcmp(extension, ".obj") || !strcmp(extension, ".OBJ")) { return ImportObj(path, mesh, weld); }
+		if (!strcmp(extension, ".ply") || !strcmp(extension, ".PLY")) { return ImportPly(path, mesh, weld); }
+		return false;
+	}
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Geometry.h"
+#include "Graphics.h"
+
+/*
+  - Mesh optimization header
+  - Welds coincident vertices, removes degenerate and duplicate triangles
+  - Reorders Mesh triangles for post-transform vertex cache (Forsyth) and vertices for linear vertex fetch
+
+  - MeshOptimizer.h:
+  - Contains realisations for MeshOptimizer
+
+  - Dependencies:
+  - Geometry.h
+  - Graphics.h
+*/
+
+///<summary>
+///Mesh cleanup and reordering passes. They do not move any vertex, so rendered result stays the same.
+///Run Weld() first, then OptimizeVertexCache() and OptimizeVertexFetch(), or all of them with Optimize()
+///</summary>
+class MeshOptimizer {
+private:
+	///<summary>
+	///Triangle indices rotated so the smallest goes first. Rotation keeps winding, so faces of opposite orientation stay different
+	///</summary>
+	typedef struct FaceKey {
+		unsigned a, b, c;
+
+		FaceKey(unsigned first, unsigned second, unsigned third) {
+			if (first < second && first < third) { a = first; b = second; c = third; }
+			else if (second < third) { a = second; b = third; c = first; }
+			else { a = third; b = first; c = second; }
+		}
+		bool operator==(const FaceKey& other) const { return a == other.a && b == other.b && c == other.c; }
+	} FaceKey;
+	typedef struct FaceKeyHash {
+		size_t operator()(const FaceKey& key) const { return (size_t)key.a * 73856093u ^ (size_t)key.b * 19349663u ^ (size_t)key.c * 83492791u; }
+	} FaceKeyHash;
+
+	static unsigned long long CellKey(long long x, long long y, long long z) {
+		return (unsigned long long)x * 73856093ull ^ (unsigned long long)y * 19349663ull ^ (unsigned long long)z * 83492791ull;
+	}
+
+	///<summary>
+	///Size of modelled vertex cache. Forsyth scores are tuned for least recently used cache of this size
+	///</summary>
+	static const unsigned CacheSize = 32;
+	///<summary>
+	///Valence scores are tabulated up to this amount of remaining triangles, higher valences use the last entry
+	///</summary>
+	static const unsigned MaxValence = 64;
+
+	static float CachePositionScore(unsigned position) {
+		//Vertices of the last triangle get fixed score, so the next triangle does not simply reuse its own edge
+		if (position < 3) { return 0.75f; }
+		return powf(1.0f - (float)(position - 3) / (CacheSize - 3), 1.5f);
+	}
+	static float ValenceScore(unsigned remaining) {
+		//Vertices with few remaining triangles are boosted, so they are finished and leave no lonely triangles behind
+		return 2.0f / sqrtf((float)remaining);
+	}
+
+public:
+	///<summary>
+	///Merges vertices closer than tolerance, then removes triangles, that became degenerate (repeated vertex or area below tolerance squared)
+	///or repeat an earlier triangle with the same winding. Unused vertices are removed. Order of remaining vertices and triangles is kept.
+	///Vertices are bucketed in spatial hash with cells of tolerance size, so each one is compared only with kept vertices of 27 nearby cells (of its own cell for zero tolerance)
+	///</summary>
+	static void Weld(Mesh& mesh, float tolerance = 1e-5f) {
+		const size_t vertSz = mesh.vertices.size();
+		const size_t triaSz = mesh.triangles.size() / 3;
+		const float cellSize = tolerance > 1e-7f ? tolerance : 1e-7f;
+		const float toleranceSq = tolerance * tolerance;
+		//Exactly equal vertices always share a cell, merging within distance needs neighbour cells too
+		const int searchedSide = tolerance > 0 ? 3 : 1, searchedCells = searchedSide * searchedSide * searchedSide;
+
+		const VertexStream& source = mesh.vertices;
+		const float* sx = source.GetX();
+		const float* sy = source.GetY();
+		const float* sz = source.GetZ();
+
+		//Kept vertices of each hash bucket are chained through next
+		std::unordered_map<unsigned long long, unsigned> buckets;
+		buckets.reserve(vertSz);
+		std::vector<unsigned> next, kept, remap(vertSz);
+		next.reserve(vertSz);
+		kept.reserve(vertSz);
+
+		for (size_t v = 0; v < vertSz; ++v) {
+			const long long cx = (long long)floorf(sx[v] / cellSize), cy = (long long)floorf(sy[v] / cellSize), cz = (long long)floorf(sz[v] / cellSize);
+			unsigned found = ~0u;
+
+			for (int i = 0; i < searchedCells && found == ~0u; ++i) {
+				auto bucket = buckets.find(CellKey(cx + i % searchedSide - searchedSide / 2, cy + i / searchedSide % searchedSide - searchedSide / 2, cz + i / (searchedSide * searchedSide) - searchedSide / 2));
+				if (bucket == buckets.end()) { continue; }
+
+				for (unsigned k = bucket->second; k != ~0u; k = next[k]) {
+					const unsigned other = kept[k];
+					const float dx = sx[v] - sx[other], dy = sy[v] - sy[other], dz = sz[v] - sz[other];
+					if (dx * dx + dy * dy + dz * dz <= toleranceSq) { found = k; break; }
+				}
+			}
+			if (found != ~0u) { remap[v] = found; continue; }
+
+			remap[v] = (unsigned)kept.size();
+			auto inserted = buckets.insert(std::make_pair(CellKey(cx, cy, cz), ~0u));
+			next.push_back(inserted.first->second);
+			inserted.first->second = (unsigned)kept.size();
+			kept.push_back((unsigned)v);
+		}
+
+		std::unordered_set<FaceKey, FaceKeyHash> faces;
+		faces.reserve(triaSz);
+		std::vector<unsigned> triangles;
+		triangles.reserve(triaSz * 3);
+		std::vector<unsigned> used(kept.size(), ~0u);
+		unsigned usedCount = 0;
+
+		for (size_t t = 0; t < triaSz; ++t) {
+			const unsigned a = remap[mesh.triangles[t * 3]], b = remap[mesh.triangles[t * 3 + 1]], c = remap[mesh.triangles[t * 3 + 2]];
+			if (a == b || b == c || a == c) { continue; }
+
+			const unsigned pa = kept[a], pb = kept[b], pc = kept[c];
+			const Vector3 cross = Vector3::Cross(Vector3(sx[pb] - sx[pa], sy[pb] - sy[pa], sz[pb] - sz[pa]), Vector3(sx[pc] - sx[pa], sy[pc] - sy[pa], sz[pc] - sz[pa]));
+			if (Vector3::Dot(cross, cross) <= toleranceSq * toleranceSq) { continue; }
+			if (!faces.insert(FaceKey(a, b, c)).second) { continue; }
+
+			triangles.push_back(a); triangles.push_back(b); triangles.push_back(c);
+			used[a] = used[b] = used[c] = 0;
+		}
+
+		//Kept vertices, that only degenerate triangles used, are dropped too
+		VertexStream vertices;
+		for (size_t k = 0; k < kept.size(); ++k) {
+			if (used[k] == ~0u) { continue; }
+			used[k] = usedCount++;
+			vertices.push_back(Vector3(sx[kept[k]], sy[kept[k]], sz[kept[k]]));
+		}
+		for (size_t i = 0; i < triangles.size(); ++i) { triangles[i] = used[triangles[i]]; }
+
+		mesh.vertices = vertices;
+		mesh.triangles.swap(triangles);
+		mesh.RecalculateNormals();
+	}
+	///<summary>
+	///Reorders triangles with Tom Forsyth's linear-speed vertex cache optimisation. Each next triangle is greedily the one
+	///with best score of its vertices: recently used and nearly finished vertices score higher. Runs in linear time
+	///</summary>
+	static void OptimizeVertexCache(Mesh& mesh) {
+		const size_t vertSz = mesh.vertices.size();
+		const size_t triaSz = mesh.triangles.size() / 3;
+		if (triaSz == 0) { return; }
+		const unsigned* indices = mesh.triangles.data();
+
+		float positionScores[CacheSize];
+		float valenceScores[MaxValence + 1];
+		for (unsigned i = 0; i < CacheSize; ++i) { positionScores[i] = CachePositionScore(i); }
+		valenceScores[0] = 0;
+		for (unsigned i = 1; i <= MaxValence; ++i) { valenceScores[i] = ValenceScore(i); }
+
+		//Triangles around each vertex: adjacency[adjacencyStart[v] .. adjacencyStart[v] + remaining[v]). Emitted triangles are swapped out of the range
+		std::vector<unsigned> remaining(vertSz, 0), adjacencyStart(vertSz + 1, 0), adjacency(triaSz * 3);
+		for (size_t i = 0; i < triaSz * 3; ++i) { ++remaining[indices[i]]; }
+		for (size_t v = 0; v < vertSz; ++v) { adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v]; remaining[v] = 0; }
+		for (size_t i = 0; i < triaSz * 3; ++i) {
+			const unsigned v = indices[i];
+			adjacency[adjacencyStart[v] + remaining[v]++] = (unsigned)(i / 3);
+		}
+
+		std::vector<int> cachePosition(vertSz, -1);
+		std::vector<float> vertexScores(vertSz), triangleScores(triaSz);
+		std::vector<unsigned char> isEmitted(triaSz, 0);
+		for (size_t v = 0; v < vertSz; ++v) { vertexScores[v] = valenceScores[remaining[v] < MaxValence ? remaining[v] : MaxValence]; }
+
+		unsigned bestTriangle = 0;
+		float bestScore = -1;
+		for (size_t t = 0; t < triaSz; ++t) {
+			triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+			if (triangleScores[t] > bestScore) { bestScore = triangleScores[t]; bestTriangle = (unsigned)t; }
+		}
+
+		//Cache holds three more entries than modelled size: vertices of new triangle are pushed before the oldest ones drop out
+		unsigned cache[CacheSize + 3], newCache[CacheSize + 3];
+		unsigned cacheCount = 0;
+		std::vector<unsigned> result(triaSz * 3);
+		size_t scanPosition = 0;
+
+		for (size_t emitted = 0; emitted < triaSz; ++emitted) {
+			if (bestScore < 0) {
+				//No triangle touches cached vertices: take the next one not emitted yet, the scan never goes back
+				while (isEmitted[scanPosition]) { ++scanPosition; }
+				bestTriangle = (unsigned)scanPosition;
+			}
+			const unsigned* tri = &indices[bestTriangle * 3];
+			result[emitted * 3] = tri[0]; result[emitted * 3 + 1] = tri[1]; result[emitted * 3 + 2] = tri[2];
+			isEmitted[bestTriangle] = 1;
+
+			//Emitted triangle leaves adjacency of its vertices
+			for (int k = 0; k < 3; ++k) {
+				const unsigned v = tri[k];
+				unsigned* list = &adjacency[adjacencyStart[v]];
+				for (unsigned i = 0; i < remaining[v]; ++i) {
+					if (list[i] == bestTriangle) { list[i] = list[remaining[v] - 1]; break; }
+				}
+				--remaining[v];
+			}
+
+			//Triangle vertices go to the front, other cached vertices keep their order behind them
+			unsigned newCount = 0;
+			newCache[newCount++] = tri[0]; newCache[newCount++] = tri[1]; newCache[newCount++] = tri[2];
+			for (unsigned i = 0; i < cacheCount; ++i) {
+				const unsigned v = cache[i];
+				if (v != tri[0] && v != tri[1] && v != tri[2]) { newCache[newCount++] = v; }
+			}
+			for (unsigned i = 0; i < newCount; ++i) { cache[i] = newCache[i]; }
+			cacheCount = newCount < CacheSize ? newCount : CacheSize;
+
+			//Vertices pushed out of the cache, then cached ones, get new scores. Only their triangles can change score
+			for (unsigned i = 0; i < newCount; ++i) {
+				const unsigned v = cache[i];
+				cachePosition[v] = i < CacheSize ? (int)i : -1;
+				const float score = remaining[v] == 0 ? -1 : (cachePosition[v] >= 0 ? positionScores[cachePosition[v]] : 0) + valenceScores[remaining[v] < MaxValence ? remaining[v] : MaxValence];
+				const float delta = score - vertexScores[v];
+				vertexScores[v] = score;
+
+				const unsigned* list = &adjacency[adjacencyStart[v]];
+				for (unsigned j = 0; j < remaining[v]; ++j) { triangleScores[list[j]] += delta; }
+			}
+
+			//Best next triangle is searched only around cached vertices
+			bestScore = -1;
+			for (unsigned i = 0; i < cacheCount; ++i) {
+				const unsigned v = cache[i];
+				const unsigned* list = &adjacency[adjacencyStart[v]];
+				for (unsigned j = 0; j < remaining[v]; ++j) {
+					if (triangleScores[list[j]] > bestScore) { bestScore = triangleScores[list[j]]; bestTriangle = list[j]; }
+				}
+			}
+		}
+
+		mesh.triangles.swap(result);
+		mesh.RecalculateNormals();
+	}
+	///<summary>
+	///Renumbers vertices in order of their first use by triangles, so vertex fetch walks memory linearly. Unused vertices are removed
+	///</summary>
+	static void OptimizeVertexFetch(Mesh& mesh) {
+		const size_t vertSz = mesh.vertices.size();
+		const size_t indexSz = mesh.triangles.size() / 3 * 3;
+		std::vector<unsigned> remap(vertSz, ~0u);
+		unsigned vertexCount = 0;
+
+		unsigned* indices = mesh.triangles.data();
+		for (size_t i = 0; i < indexSz; ++i) {
+			if (remap[indices[i]] == ~0u) { remap[indices[i]] = vertexCount++; }
+			indices[i] = remap[indices[i]];
+		}
+		mesh.triangles.resize(indexSz);
+
+		VertexStream vertices;
+		vertices.resize(vertexCount);
+		const VertexStream& source = mesh.vertices;
+		const float* sx = source.GetX();
+		const float* sy = source.GetY();
+		const float* sz = source.GetZ();
+		float* vx = vertices.GetX();
+		float* vy = vertices.GetY();
+		float* vz = vertices.GetZ();
+		for (size_t v = 0; v < vertSz; ++v) {
+			if (remap[v] == ~0u) { continue; }
+			vx[remap[v]] = sx[v]; vy[remap[v]] = sy[v]; vz[remap[v]] = sz[v];
+		}
+		mesh.vertices = vertices;
+		mesh.RecalculateNormals();
+	}
+	///<summary>
+	///Runs welding with given tolerance, then vertex cache and vertex fetch optimization
+	///</summary>
+	static void Optimize(Mesh& mesh, float weldTolerance = 1e-5f) {
+		Weld(mesh, weldTolerance);
+		OptimizeVertexCache(mesh);
+		OptimizeVertexFetch(mesh);
+	}
+	///<summary>
+	///Returns average amount of vertex shader runs per triangle for first in first out cache of given size. 3 is the worst, about 0.5 is the best for closed meshes
+	///</summary>
+	static float AverageCacheMissRatio(const std::vector<unsigned>& triangles, size_t vertexCount, unsigned cacheSize = 16) {
+		const size_t triaSz = triangles.size() / 3;
+		if (triaSz == 0) { return 0; }
+
+		//Vertex is in cache if it was loaded less than cacheSize misses ago
+		std::vector<size_t> loadedAt(vertexCount, 0);
+		size_t misses = 0;
+		for (size_t i = 0; i < triaSz * 3; ++i) {
+			const unsigned v = triangles[i];
+			if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize) { loadedAt[v] = ++misses; }
+		}
+		return (float)misses / triaSz;
+	}
+};
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "Geometry.h"
+#include "Graphics.h"
+
+/*
+  - Mesh simplification header
+  - Reduces triangle count of a Mesh with quadric error metric edge collapses (Garland and Heckbert)
+
+  - MeshSimplifier.h:
+  - Contains realisations for Quadric, MeshSimplifier
+
+  - Dependencies:
+  - Geometry.h
+  - Graphics.h
+*/
+
+///<summary>
+///Symmetric 4x4 matrix, that measures sum of squared distances from a point to set of planes
+///</summary>
+typedef struct Quadric {
+	double aa, ab, ac, ad, bb, bc, bd, cc, cd, dd;
+
+	Quadric() { aa = ab = ac = ad = bb = bc = bd = cc = cd = dd = 0; }
+	///<summary>
+	///Quadric of plane a * x + b * y + c * z + d = 0 with normalized (a, b, c)
+	///</summary>
+	Quadric(double a, double b, double c, double d) {
+		aa = a * a; ab = a * b; ac = a * c; ad = a * d;
+		bb = b * b; bc = b * c; bd = b * d;
+		cc = c * c; cd = c * d;
+		dd = d * d;
+	}
+
+	Quadric& operator+=(const Quadric& q) {
+		aa += q.aa; ab += q.ab; ac += q.ac; ad += q.ad;
+		bb += q.bb; bc += q.bc; bd += q.bd;
+		cc += q.cc; cd += q.cd;
+		dd += q.dd;
+		return *this;
+	}
+	Quadric operator+(const Quadric& q) const { Quadric sum = *this; sum += q; return sum; }
+
+	///<summary>
+	///Returns sum of squared distances from point to planes of this quadric
+	///</summary>
+	double Evaluate(const Vector3& p) const {
+		const double x = p.x, y = p.y, z = p.z;
+		return aa * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+			+ bb * y * y + 2 * bc * y * z + 2 * bd * y
+			+ cc * z * z + 2 * cd * z + dd;
+	}
+	///<summary>
+	///Finds point with minimal error. Returns false if quadric is singular (planes are parallel)
+	///</summary>
+	bool Minimum(Vector3& result) const {
+		const double c00 = bb * cc - bc * bc, c01 = ac * bc - ab * cc, c02 = ab * bc - ac * bb;
+		const double det = aa * c00 + ab * c01 + ac * c02;
+		if (fabs(det) < 1e-12) { return false; }
+
+		const double c11 = aa * cc - ac * ac, c12 = ab * ac - aa * bc, c22 = aa * bb - ab * ab;
+		const double inv = -1.0 / det;
+		result = Vector3(
+			(float)(inv * (c00 * ad + c01 * bd + c02 * cd)),
+			(float)(inv * (c01 * ad + c11 * bd + c12 * cd)),
+			(float)(inv * (c02 * ad + c12 * bd + c22 * cd))
+		);
+		return true;
+	}
+} Quadric;
+
+///<summary>
+///Edge collapse simplifier. Border and non-manifold edges are kept in place, so open meshes keep their outline.
+///Collapses, that would make surface non-manifold, are skipped, so closed mesh is never reduced below a tetrahedron.
+///Simplification may be continued to lower triangle counts, which gives consistent chain of levels of detail
+///</summary>
+class MeshSimplifier {
+private:
+	typedef struct Collapse {
+		float cost;
+		unsigned keep, remove;
+		unsigned keepVersion, removeVersion;
+		Vector3 target;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	} Collapse;
+
+	std::vector<Vector3> positions;
+	std::vector<Quadric> quadrics;
+	std::vector<unsigned> versions;
+	std::vector<unsigned char> isBorder, isRemoved;
+	///<summary>
+	///Last collapse, that visited each vertex. Used to push every edge around collapsed vertex once
+	///</summary>
+	std::vector<unsigned> visited;
+	unsigned collapseCount;
+	///<summary>
+	///Scratch of link condition: neighbours of kept vertex carry current stamp, shared neighbours the next one
+	///</summary>
+	std::vector<unsigned> linkMarks, sharedNeighbours;
+	unsigned linkStamp;
+
+	std::vector<unsigned> indices;
+	std::vector<unsigned char> isTriangleRemoved;
+	size_t triangleCount;
+
+	///<summary>
+	///Triangles around each vertex: refs[refStart[v] .. refStart[v] + refCount[v]). Lists of changed vertices are appended to the end
+	///</summary>
+	std::vector<unsigned> refs, refStart, refCount;
+	size_t initialRefsSize;
+
+	std::vector<Collapse> heap;
+	float maxCost;
+
+	void BuildReferences(void) {
+		const size_t vertSz = positions.size();
+		refCount.assign(vertSz, 0);
+		refStart.assign(vertSz, 0);
+
+		for (size_t t = 0; t < isTriangleRemoved.size(); ++t) {
+			if (isTriangleRemoved[t]) { continue; }
+			for (int k = 0; k < 3; ++k) { ++refCount[indices[t * 3 + k]]; }
+		}
+		unsigned offset = 0;
+		for (size_t v = 0; v < vertSz; ++v) { refStart[v] = offset; offset += refCount[v]; refCount[v] = 0; }
+
+		refs.resize(offset);
+		for (size_t t = 0; t < isTriangleRemoved.size(); ++t) {
+			if (isTriangleRemoved[t]) { continue; }
+			for (int k = 0; k < 3; ++k) {
+				const unsigned v = indices[t * 3 + k];
+				refs[refStart[v] + refCount[v]++] = (unsigned)t;
+			}
+		}
+		initialRefsSize = refs.size();
+	}
+	///<summary>
+	///Marks vertices of edges used by one or more than two triangles
+	///</summary>
+	void FindBorders(void) {
+		std::unordered_map<unsigned long long, unsigned> edgeUses;
+		edgeUses.reserve(indices.size());
+
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			for (int k = 0; k < 3; ++k) {
+				const unsigned a = indices[i + k], b = indices[i + (k + 1) % 3];
+				++edgeUses[a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a];
+			}
+		}
+		for (auto it = edgeUses.begin(); it != edgeUses.end(); ++it) {
+			if (it->second == 2) { continue; }
+			isBorder[(unsigned)(it->first >> 32)] = 1;
+			isBorder[(unsigned)(it->first & 0xFFFFFFFFu)] = 1;
+		}
+	}
+	///<summary>
+	///Finds best position and cost of collapsing edge. Returns false if edge must be kept
+	///</summary>
+	bool Evaluate(unsigned a, unsigned b, Collapse& collapse) const {
+		if (isBorder[a] && isBorder[b]) { return false; }
+		if (isBorder[b]) { unsigned t = a; a = b; b = t; } // border vertex stays in place
+
+		const Quadric q = quadrics[a] + quadrics[b];
+		Vector3 target = positions[a];
+		double cost = q.Evaluate(target);
+
+		if (!isBorder[a]) {
+			const Vector3 candidates[2] = { positions[b], (Vector3(positions[a]) + positions[b]) / 2 };
+			for (int i = 0; i < 2; ++i) {
+				const double candidateCost = q.Evaluate(candidates[i]);
+				if (candidateCost < cost) { cost = candidateCost; target = candidates[i]; }
+			}
+
+			Vector3 optimal;
+			if (q.Minimum(optimal)) {
+				//Far optimum means nearly parallel planes, which is numerically unstable
+				const float edgeLength = Vector3::Distance(positions[a], positions[b]);
+				const double optimalCost = q.Evaluate(optimal);
+				if (Vector3::Distance(optimal, candidates[1]) <= edgeLength * 2 && optimalCost < cost) { cost = optimalCost; target = optimal; }
+			}
+		}
+
+		collapse.cost = (float)(cost > 0 ? cost : 0);
+		collapse.keep = a; collapse.remove = b;
+		collapse.keepVersion = versions[a]; collapse.removeVersion = versions[b];
+		collapse.target = target;
+		return true;
+	}
+	void Push(unsigned a, unsigned b) {
+		Collapse collapse;
+		if (!Evaluate(a, b, collapse)) { return; }
+		heap.push_back(collapse);
+		std::push_heap(heap.begin(), heap.end(), std::greater<Collapse>());
+	}
+	///<summary>
+	///Returns true if moving vertex to target turns any of its triangles by more than 60 degrees or collapses it, except ones shared
+	///with other vertex. Small limit keeps many collapses in a row from folding triangle over
+	///</summary>
+	bool Flips(unsigned vertex, unsigned other, const Vector3& target) const {
+		const unsigned start = refStart[vertex], end = start + refCount[vertex];
+		for (unsigned r = start; r < end; ++r) {
+			const unsigned t = refs[r];
+			if (isTriangleRemoved[t]) { continue; }
+
+			const unsigned* tri = &indices[t * 3];
+			if (tri[0] == other || tri[1] == other || tri[2] == other) { continue; }
+
+			Vector3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+			const Vector3 oldNormal = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+			for (int k = 0; k < 3; ++k) { if (tri[k] == vertex) { p[k] = target; } }
+			const Vector3 newNormal = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+
+			const float newLength = newNormal.Length(), oldLength = oldNormal.Length();
+			if (newLength <= 1e-12f * (oldLength + 1e-12f)) { return true; }
+			if (Vector3::Dot(oldNormal, newNormal) < 0.5f * oldLength * newLength) { return true; }
+		}
+		return false;
+	}
+	///<summary>
+	///Returns true if collapsing edge breaks the surface (link condition). Vertices connected to both ends must be exactly the opposite vertices
+	///of triangles on the edge, and must not be connected to each other. Otherwise collapse leaves duplicate or back to back triangles
+	///</summary>
+	bool BreaksManifold(unsigned keep, unsigned remove) {
+		linkStamp += 2;
+		const unsigned keepStart = refStart[keep], keepEnd = keepStart + refCount[keep];
+		for (unsigned r = keepStart; r < keepEnd; ++r) {
+			if (isTriangleRemoved[refs[r]]) { continue; }
+			const unsigned* tri = &indices[refs[r] * 3];
+			for (int k = 0; k < 3; ++k) { if (tri[k] != keep) { linkMarks[tri[k]] = linkStamp; } }
+		}
+
+		sharedNeighbours.clear();
+		size_t edgeTriangles = 0;
+		const unsigned removeStart = refStart[remove], removeEnd = removeStart + refCount[remove];
+		for (unsigned r = removeStart; r < removeEnd; ++r) {
+			if (isTriangleRemoved[refs[r]]) { continue; }
+			const unsigned* tri = &indices[refs[r] * 3];
+			if (tri[0] == keep || tri[1] == keep || tri[2] == keep) { ++edgeTriangles; }
+			for (int k = 0; k < 3; ++k) {
+				const unsigned v = tri[k];
+				if (v == remove || v == keep || linkMarks[v] != linkStamp) { continue; }
+				linkMarks[v] = linkStamp + 1;
+				sharedNeighbours.push_back(v);
+			}
+		}
+		if (sharedNeighbours.size() != edgeTriangles) { return true; }
+
+		for (size_t i = 0; i < sharedNeighbours.size(); ++i) {
+			const unsigned v = sharedNeighbours[i];
+			const unsigned start = refStart[v], end = start + refCount[v];
+			for (unsigned r = start; r < end; ++r) {
+				if (isTriangleRemoved[refs[r]]) { continue; }
+				const unsigned* tri = &indices[refs[r] * 3];
+				for (int k = 0; k < 3; ++k) { if (tri[k] != v && linkMarks[tri[k]] == linkStamp + 1) { return true; } }
+			}
+		}
+		return false;
+	}
+	void ApplyCollapse(const Collapse& collapse) {
+		const unsigned keep = collapse.keep, remove = collapse.remove;
+
+		//Remove triangles on collapsed edge, move others of removed vertex to kept one
+		const unsigned removeStart = refStart[remove], removeEnd = removeStart + refCount[remove];
+		for (unsigned r = removeStart; r < removeEnd; ++r) {
+			const unsigned t = refs[r];
+			if (isTriangleRemoved[t]) { continue; }
+
+			unsigned* tri = &indices[t * 3];
+			if (tri[0] == keep || tri[1] == keep || tri[2] == keep) {
+				isTriangleRemoved[t] = 1;
+				--triangleCount;
+				continue;
+			}
+			for (int k = 0; k < 3; ++k) { if (tri[k] == remove) { tri[k] = keep; } }
+		}
+
+		//New reference list of kept vertex is appended to the end
+		const unsigned keepStart = refStart[keep], keepEnd = keepStart + refCount[keep];
+		const unsigned newStart = (unsigned)refs.size();
+		for (unsigned r = keepStart; r < keepEnd; ++r) { if (!isTriangleRemoved[refs[r]]) { refs.push_back(refs[r]); } }
+		for (unsigned r = removeStart; r < removeEnd; ++r) { if (!isTriangleRemoved[refs[r]]) { refs.push_back(refs[r]); } }
+		refStart[keep] = newStart;
+		refCount[keep] = (unsigned)refs.size() - newStart;
+		refCount[remove] = 0;
+
+		positions[keep] = collapse.target;
+		quadrics[keep] += quadrics[remove];
+		isRemoved[remove] = 1;
+		++versions[keep];
+		++versions[remove];
+		if (collapse.cost > maxCost) { maxCost = collapse.cost; }
+
+		if (refs.size() > initialRefsSize * 3 + 1024) {
+			BuildReferences();
+		}
+
+		++collapseCount;
+		const unsigned start = refStart[keep], end = start + refCount[keep];
+		for (unsigned r = start; r < end; ++r) {
+			const unsigned* tri = &indices[refs[r] * 3];
+			for (int k = 0; k < 3; ++k) {
+				if (tri[k] == keep || visited[tri[k]] == collapseCount) { continue; }
+				visited[tri[k]] = collapseCount;
+				Push(keep, tri[k]);
+			}
+		}
+	}
+
+public:
+	MeshSimplifier(const Mesh& mesh) {
+		const size_t vertSz = mesh.vertices.size();
+		const size_t triaSz = mesh.triangles.size() / 3;
+
+		positions.resize(vertSz);
+		for (size_t i = 0; i < vertSz; ++i) { positions[i] = mesh.vertices[i]; }
+		quadrics.assign(vertSz, Quadric());
+		versions.assign(vertSz, 0);
+		isBorder.assign(vertSz, 0);
+		isRemoved.assign(vertSz, 0);
+		visited.assign(vertSz, 0);
+		collapseCount = 0;
+		linkMarks.assign(vertSz, 0);
+		linkStamp = 0;
+		maxCost = 0;
+
+		indices.assign(mesh.triangles.begin(), mesh.triangles.begin() + triaSz * 3);
+		isTriangleRemoved.assign(triaSz, 0);
+		triangleCount = triaSz;
+
+		//Plane of every triangle is added to its vertices
+		for (size_t t = 0; t < triaSz; ++t) {
+			const unsigned* tri = &indices[t * 3];
+			if (tri[0] >= vertSz || tri[1] >= vertSz || tri[2] >= vertSz) { isTriangleRemoved[t] = 1; --triangleCount; continue; }
+
+			const Vector3 normal = Vector3::Cross(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+			const float length = normal.Length();
+			if (length <= 0) { continue; }
+
+			const Vector3 n = Vector3(normal) / length;
+			const Quadric plane(n.x, n.y, n.z, -Vector3::Dot(n, positions[tri[0]]));
+			for (int k = 0; k < 3; ++k) { quadrics[tri[k]] += plane; }
+		}
+
+		FindBorders();
+		BuildReferences();
+
+		//Each interior edge is seen from both triangles, add it once
+		heap.reserve(triaSz * 2);
+		for (size_t t = 0; t < triaSz; ++t) {
+			if (isTriangleRemoved[t]) { continue; }
+			for (int k = 0; k < 3; ++k) {
+				const unsigned a = indices[t * 3 + k], b = indices[t * 3 + (k + 1) % 3];
+				Collapse collapse;
+				if (a < b && Evaluate(a, b, collapse)) { heap.push_back(collapse); }
+			}
+		}
+		std::make_heap(heap.begin(), heap.end(), std::greater<Collapse>());
+	}
+
+	///<summary>
+	///Collapses cheapest edges until triangle count is not above target or next collapse would exceed maxError (in object units).
+	///Returns false if target was not reached
+	///</summary>
+	bool SimplifyTo(size_t targetTriangles, float maxError = FLT_MAX) {
+		const float maxErrorCost = maxError < sqrtf(FLT_MAX) ? maxError * maxError : FLT_MAX;
+
+		while (triangleCount > targetTriangles && !heap.empty()) {
+			const Collapse collapse = heap.front();
+			if (collapse.cost > maxErrorCost) { return false; }
+
+			std::pop_heap(heap.begin(), heap.end(), std::greater<Collapse>());
+			heap.pop_back();
+
+			if (isRemoved[collapse.keep] || isRemoved[collapse.remove]) { continue; }
+			if (versions[collapse.keep] != collapse.keepVersion || versions[collapse.remove] != collapse.removeVersion) { continue; }
+			if (Flips(collapse.keep, collapse.remove, collapse.target) || Flips(collapse.remove, collapse.keep, collapse.target)) { continue; }
+			if (BreaksManifold(collapse.keep, collapse.remove)) { continue; }
+
+			ApplyCollapse(collapse);
+		}
+		return triangleCount <= targetTriangles;
+	}
+	size_t GetTriangleCount(void) const { return triangleCount; }
+	///<summary>
+	///Returns geometric error of current result: square root of largest collapse cost, in object units
+	///</summary>
+	float GetError(void) const { return sqrtf(maxCost); }
+	///<summary>
+	///Returns simplified mesh. Unused vertices are removed, order of remaining vertices and triangles is kept
+	///</summary>
+	Mesh GetMesh(void) const {
+		Mesh result;
+		std::vector<unsigned> remap(positions.size(), ~0u);
+		unsigned vertexCount = 0;
+
+		for (size_t t = 0; t < isTriangleRemoved.size(); ++t) {
+			if (isTriangleRemoved[t]) { continue; }
+			for (int k = 0; k < 3; ++k) { remap[indices[t * 3 + k]] = 0; }
+		}
+		for (size_t v = 0; v < positions.size(); ++v) { if (remap[v] == 0) { remap[v] = vertexCount++; } }
+
+		result.vertices.resize(vertexCount);
+		for (size_t v = 0; v < positions.size(); ++v) { if (remap[v] != ~0u) { result.vertices.Set(remap[v], positions[v]); } }
+
+		result.triangles.reserve(triangleCount * 3);
+		for (size_t t = 0; t < isTriangleRemoved.size(); ++t) {
+			if (isTriangleRemoved[t]) { continue; }
+			for (int k = 0; k < 3; ++k) { result.triangles.push_back(remap[indices[t * 3 + k]]); }
+		}
+		return result;
+	}
+
+	///<summary>
+	///Returns mesh reduced to target triangle count, never below it. Result stays more detailed if next collapse would exceed maxError
+	///(in object units); for a bound by error only pass targetTriangles = 0
+	///</summary>
+	static Mesh Simplify(const Mesh& mesh, size_t targetTriangles, float maxError = FLT_MAX) {
+		MeshSimplifier simplifier(mesh);
+		simplifier.SimplifyTo(targetTriangles, maxError);
+		return simplifier.GetMesh();
+	}
+	///<summary>
+	///Builds level of detail chain. Each next level has ratio of previous level triangles. Stops early when mesh can not be reduced further
+	///</summary>
+	static LodMesh GenerateLod(const Mesh& mesh, unsigned levelCount, float ratio = 0.5f) {
+		LodMesh lodMesh(mesh);
+		MeshSimplifier simplifier(mesh);
+		size_t target = simplifier.GetTriangleCount();
+
+		for (unsigned level = 1; level < levelCount; ++level) {
+			const size_t previous = simplifier.GetTriangleCount();
+			target = (size_t)(target * ratio);
+			simplifier.SimplifyTo(target);
+			if (simplifier.GetTriangleCount() >= previous) { break; }
+
+			lodMesh.AddLevel(simplifier.GetMesh(), simplifier.GetError());
+		}
+		return lodMesh;
+	}
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <gl/freeglut.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cstddef>
+
+/*
+  - Platform header
+  - OpenGL headers, render context creation and read-only file mapping for each supported platform
+
+  - Platform.h:
+  - Contains realisations for RenderContext, MappedFile
+  - Win32: WGL context on a window device context
+  - Linux: headless EGL context on an offscreen pbuffer. Works with Mesa's software rasterizer (llvmpipe)
+*/
+
+#ifdef _WIN32
+
+class RenderContext {
+private:
+	HWND window;
+	HDC deviceContext;
+	HGLRC renderContext;
+
+public:
+	RenderContext() { window = NULL; deviceContext = NULL; renderContext = NULL; }
+
+	///<summary>
+	///Creates OpenGL context for given window. Call MakeCurrent() to use it
+	///</summary>
+	bool Create(HWND targetWindow) {
+		PIXELFORMATDESCRIPTOR pixelFormatDescriptor = { 0 };
+		int                   pixelFormat;
+
+		window = targetWindow;
+		deviceContext = GetDC(window);
+
+		pixelFormatDescriptor.nSize = sizeof(PIXELFORMATDESCRIPTOR);
+		pixelFormatDescriptor.nVersion = 1;
+		pixelFormatDescriptor.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+		pixelFormatDescriptor.iPixelType = PFD_TYPE_RGBA;
+		pixelFormatDescriptor.cColorBits = 32;
+		pixelFormat = ChoosePixelFormat(deviceContext, &pixelFormatDescriptor);
+
+		SetPixelFormat(deviceContext, pixelFormat, &pixelFormatDescriptor);
+		DescribePixelFormat(deviceContext, pixelFormat, sizeof(PIXELFORMATDESCRIPTOR), &pixelFormatDescriptor);
+		renderContext = wglCreateContext(deviceContext);
+
+		return renderContext != NULL;
+	}
+	///<summary>
+	///Creates OpenGL context on a hidden window of given size, for rendering without visible window. Call MakeCurrent() to use it
+	///</summary>
+	bool CreateOffscreen(int width, int height) {
+		WNDCLASSW windowClass = { 0 };
+		windowClass.style = CS_OWNDC;
+		windowClass.lpfnWndProc = DefWindowProcW;
+		windowClass.hInstance = GetModuleHandleW(NULL);
+		windowClass.lpszClassName = L"OffscreenContext";
+		RegisterClassW(&windowClass);
+
+		HWND hiddenWindow = CreateWindowW(L"OffscreenContext", L"", WS_POPUP, 0, 0, width, height, NULL, NULL, windowClass.hInstance, NULL);
+		if (!hiddenWindow) { return false; }
+		return Create(hiddenWindow);
+	}
+	bool MakeCurrent(void) { return wglMakeCurrent(deviceContext, renderContext) == TRUE; }
+	///<summary>
+	///Shows rendered frame. Blocks until vertical blank if swap interval is not zero
+	///</summary>
+	void Present(void) { SwapBuffers(deviceContext); }
+	///<summary>
+	///Sets amount of vertical blanks to wait in Present(). 0 disables vsync. Returns false if not supported
+	///</summary>
+	bool SetSwapInterval(int interval) {
+		typedef BOOL (WINAPI* PSwapIntervalEXT)(int interval);
+		PSwapIntervalEXT swapIntervalEXT = (PSwapIntervalEXT)GetFunctionAddress("wglSwapIntervalEXT");
+		return swapIntervalEXT && swapIntervalEXT(interval);
+	}
+	void Destroy(void) {
+		wglMakeCurrent(deviceContext, NULL);
+		if (renderContext) { wglDeleteContext(renderContext); }
+		if (deviceContext) { ReleaseDC(window, deviceContext); }
+		renderContext = NULL;
+		deviceContext = NULL;
+	}
+
+	///<summary>
+	///Returns address of OpenGL function or nullptr. Needs current context
+	///</summary>
+	static void* GetFunctionAddress(const char* name) {
+		void* proc = (void*)wglGetProcAddress(name);
+		if (proc == (void*)1 || proc == (void*)2 || proc == (void*)3 || proc == (void*)-1) { return nullptr; } // wglGetProcAddress failure codes
+		return proc;
+	}
+};
+
+#else
+
+class RenderContext {
+private:
+	EGLDisplay display;
+	EGLSurface surface;
+	EGLContext context;
+	int width, height;
+
+	static EGLDisplay OpenDisplay(void) {
+		//Surfaceless Mesa platform needs no X or Wayland server
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		EGLint major, minor;
+
+		if (getPlatformDisplay) {
+			EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+			if (surfaceless != EGL_NO_DISPLAY && eglInitialize(surfaceless, &major, &minor)) { return surfaceless; }
+		}
+
+		EGLDisplay fallback = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (fallback != EGL_NO_DISPLAY && eglInitialize(fallback, &major, &minor)) { return fallback; }
+		return EGL_NO_DISPLAY;
+	}
+
+public:
+	RenderContext() { display = EGL_NO_DISPLAY; surface = EGL_NO_SURFACE; context = EGL_NO_CONTEXT; width = 0; height = 0; }
+
+	///<summary>
+	///Creates desktop OpenGL (compatibility profile) context, that renders into offscreen framebuffer of given size. Call MakeCurrent() to use it
+	///</summary>
+	bool CreateOffscreen(int Width, int Height) {
+		display = OpenDisplay();
+		if (display == EGL_NO_DISPLAY) { return false; }
+
+		const EGLint configAttributes[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+			EGL_DEPTH_SIZE, 24,
+			EGL_NONE
+		};
+		EGLConfig config;
+		EGLint configCount = 0;
+		if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) { Destroy(); return false; }
+
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, Width, EGL_HEIGHT, Height, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+		if (surface == EGL_NO_SURFACE) { Destroy(); return false; }
+
+		if (!eglBindAPI(EGL_OPENGL_API)) { Destroy(); return false; }
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+		if (context == EGL_NO_CONTEXT) { Destroy(); return false; }
+
+		width = Width;
+		height = Height;
+		return true;
+	}
+	bool MakeCurrent(void) { return eglMakeCurrent(display, surface, surface, context) == EGL_TRUE; }
+	///<summary>
+	///Finishes frame. Offscreen surface has no front buffer, so nothing is shown
+	///</summary>
+	void Present(void) { eglSwapBuffers(display, surface); }
+	///<summary>
+	///Sets amount of vertical blanks to wait in Present(). Returns false if not supported
+	///</summary>
+	bool SetSwapInterval(int interval) { return eglSwapInterval(display, interval) == EGL_TRUE; }
+	void Destroy(void) {
+		if (display == EGL_NO_DISPLAY) { return; }
+
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (context != EGL_NO_CONTEXT) { eglDestroyContext(display, context); }
+		if (surface != EGL_NO_SURFACE) { eglDestroySurface(display, surface); }
+		eglTerminate(display);
+
+		display = EGL_NO_DISPLAY; surface = EGL_NO_SURFACE; context = EGL_NO_CONTEXT;
+	}
+	int GetWidth(void) const { return width; }
+	int GetHeight(void) const { return height; }
+
+	///<summary>
+	///Returns address of OpenGL function or nullptr
+	///</summary>
+	static void* GetFunctionAddress(const char* name) { return (void*)eglGetProcAddress(name); }
+};
+
+#endif
+
+///<summary>
+///Whole file mapped read-only into memory. Pages are loaded by the operating system on first access, so opening costs no reads.
+///Mapping starts at page boundary. Not copyable, unmapped in destructor
+///</summary>
+class MappedFile {
+private:
+#ifdef _WIN32
+	HANDLE file, mapping;
+#endif
+	const unsigned char* data;
+	size_t size;
+
+public:
+#ifdef _WIN32
+	MappedFile() { file = INVALID_HANDLE_VALUE; mapping = NULL; data = nullptr; size = 0; }
+#else
+	MappedFile() { data = nullptr; size = 0; }
+#endif
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { Close(); }
+
+	///<summary>
+	///Maps file at given path. Returns false if it can not be opened or is empty
+	///</summary>
+	bool Open(const char* path) {
+		Close();
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { Close(); return false; }
+
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!mapping) { Close(); return false; }
+		data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) { Close(); return false; }
+		size = (size_t)fileSize.QuadPart;
+#else
+		const int descriptor = open(path, O_RDONLY);
+		if (descriptor < 0) { return false; }
+
+		struct stat status;
+		if (fstat(descriptor, &status) != 0 || status.st_size == 0) { close(descriptor); return false; }
+
+		//Mapping keeps its own reference to the file, descriptor is not needed after mmap
+		void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		close(descriptor);
+		if (view == MAP_FAILED) { return false; }
+		data = (const unsigned char*)view;
+		size = (size_t)status.st_size;
+#endif
+		return true;
+	}
+	void Close(void) {
+#ifdef _WIN32
+		if (data) { UnmapViewOfFile(data); }
+		if (mapping) { CloseHandle(mapping); }
+		if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+		file = INVALID_HANDLE_VALUE; mapping = NULL;
+#else
+		if (data) { munmap((void*)data, size); }
+#endif
+		data = nullptr; size = 0;
+	}
+
+	bool IsOpen(void) const { return data != nullptr; }
+	const unsigned char* GetData(void) const { return data; }
+	size_t GetSize(void) const { return size; }
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+  - Profiler header
+  - Hierarchical CPU profiler: scoped zones are recorded per thread into lock-free rings and exported as Chrome trace JSON,
+    that opens in chrome://tracing or ui.perfetto.dev. Nested zones show as nested slices
+
+  - Profiler.h:
+  - Contains realisations for ProfileEvent, ProfilerTrack, Profiler, ProfileScope
+
+  - Usage:
+  - PROFILE_SCOPE("Name") at start of a block records it as zone. Profiler::Get().SetEnabled(true) starts recording,
+    Profiler::Get().WriteTrace("trace.json") writes what was recorded
+  - Define PROFILER_DISABLED to compile every PROFILE_SCOPE out
+*/
+
+#define ProfilerTrackCapacity	65536	// events kept per track; oldest are overwritten
+
+///<summary>
+///One finished zone. Name must be a string with static lifetime, times are in nanoseconds
+///</summary>
+typedef struct ProfileEvent {
+	const char* name;
+	long long begin, end;
+} ProfileEvent;
+
+///<summary>
+///Ring of events, written by one thread only. Readers take the written counter and skip events, that were overwritten while reading
+///</summary>
+typedef struct ProfilerTrack {
+	///<summary>
+	///Event slot. Fields are relaxed atomics, so a reader racing with the writer gets a torn event to discard, never undefined behaviour
+	///</summary>
+	typedef struct Slot {
+		std::atomic<const char*> name;
+		std::atomic<long long> begin, end;
+	} Slot;
+
+	std::string name;
+	unsigned id;
+	std::unique_ptr<Slot[]> slots;
+	std::atomic<size_t> written, cleared;
+
+	ProfilerTrack(const std::string& trackName, unsigned trackId) : name(trackName), id(trackId), slots(new Slot[ProfilerTrackCapacity]) { written.store(0); cleared.store(0); }
+
+	void Push(const char* eventName, long long begin, long long end) {
+		const size_t index = written.load(std::memory_order_relaxed);
+		Slot& slot = slots[index % ProfilerTrackCapacity];
+		slot.name.store(eventName, std::memory_order_relaxed);
+		slot.begin.store(begin, std::memory_order_relaxed);
+		slot.end.store(end, std::memory_order_relaxed);
+		written.store(index + 1, std::memory_order_release);
+	}
+	ProfileEvent Read(size_t index) const {
+		const Slot& slot = slots[index % ProfilerTrackCapacity];
+		ProfileEvent event;
+		event.name = slot.name.load(std::memory_order_relaxed);
+		event.begin = slot.begin.load(std::memory_order_relaxed);
+		event.end = slot.end.load(std::memory_order_relaxed);
+		return event;
+	}
+} ProfilerTrack;
+
+///<summary>
+///Owner of every track. Recording is off until SetEnabled(true): a disabled zone costs one atomic load
+///</summary>
+class Profiler {
+private:
+	std::atomic<bool> isEnabled;
+	std::mutex trackMutex;
+	std::vector<std::unique_ptr<ProfilerTrack>> tracks;		// never shrinks, so track pointers stay valid for threads, that keep them
+	long long epoch;
+
+	Profiler() { isEnabled.store(false); epoch = Now(); }
+
+	static void WriteEscaped(FILE* output, const char* text) {
+		for (; *text; ++text) {
+			if (*text == '"' || *text == '\\') { fputc('\\', output); }
+			if ((unsigned char)*text >= 0x20) { fputc(*text, output); }
+		}
+	}
+
+public:
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	///<summary>
+	///Returns profiler shared by all threads
+	///</summary>
+	static Profiler& Get(void) {
+		static Profiler shared;
+		return shared;
+	}
+	///<summary>
+	///Returns monotonic time in nanoseconds
+	///</summary>
+	static long long Now(void) { return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+	void SetEnabled(bool enabled) { isEnabled.store(enabled, std::memory_order_relaxed); }
+	bool IsEnabled(void) const { return isEnabled.load(std::memory_order_relaxed); }
+
+	///<summary>
+	///Creates track with given name, or "Thread <id>" for empty one. Its events may be pushed by one thread at a time
+	///</summary>
+	ProfilerTrack& CreateTrack(const std::string& name) {
+		std::lock_guard<std::mutex> lock(trackMutex);
+		const unsigned id = (unsigned)tracks.size();
+		tracks.push_back(std::unique_ptr<ProfilerTrack>(new ProfilerTrack(name.empty() ? "Thread " + std::to_string(id) : name, id)));
+		return *tracks.back();
+	}
+	///<summary>
+	///Returns track of calling thread. It is created on first use
+	///</summary>
+	ProfilerTrack& GetThreadTrack(void) {
+		static thread_local ProfilerTrack* track = nullptr;
+		if (!track) { track = &CreateTrack(std::string()); }
+		return *track;
+	}
+	///<summary>
+	///Sets name of calling thread, shown in trace viewer
+	///</summary>
+	void SetThreadName(const std::string& name) {
+		ProfilerTrack& track = GetThreadTrack();
+		std::lock_guard<std::mutex> lock(trackMutex);
+		track.name = name;
+	}
+	///<summary>
+	///Records finished zone of calling thread
+	///</summary>
+	void Record(const char* name, long long begin, long long end) { GetThreadTrack().Push(name, begin, end); }
+	///<summary>
+	///Drops every recorded event. Zones, that are being recorded meanwhile, may be kept
+	///</summary>
+	void Clear(void) {
+		std::lock_guard<std::mutex> lock(trackMutex);
+		for (size_t t = 0; t < tracks.size(); ++t) { tracks[t]->cleared.store(tracks[t]->written.load(std::memory_order_acquire)); }
+	}
+
+	///<summary>
+	///Copies recorded events of given track, oldest first. May be called while its thread keeps recording
+	///</summary>
+	static void ReadTrack(const ProfilerTrack& track, std::vector<ProfileEvent>& events) {
+		events.clear();
+		const size_t last = track.written.load(std::memory_order_acquire);
+		size_t first = track.cleared.load();
+		if (last - first > ProfilerTrackCapacity) { first = last - ProfilerTrackCapacity; }
+		for (size_t i = first; i < last; ++i) { events.push_back(track.Read(i)); }
+
+		//Events, that the writer reached again while they were copied, may be torn
+		const size_t overwritten = track.written.load(std::memory_order_acquire) - first;
+		if (overwritten > ProfilerTrackCapacity) { events.erase(events.begin(), events.begin() + std::min(events.size(), overwritten - ProfilerTrackCapacity)); }
+	}
+	///<summary>
+	///Writes every recorded event in Chrome trace event format. Times are microseconds since profiler creation. Returns false if file can not be written
+	///</summary>
+	bool WriteTrace(const char* path) {
+		FILE* output = fopen(path, "wb");
+		if (!output) { return false; }
+
+		std::lock_guard<std::mutex> lock(trackMutex);
+		std::vector<ProfileEvent> events;
+		bool isFirst = true;
+
+		fprintf(output, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		for (size_t t = 0; t < tracks.size(); ++t) {
+			const ProfilerTrack& track = *tracks[t];
+			fprintf(output, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"", isFirst ? "" : ",\n", track.id);
+			WriteEscaped(output, track.name.c_str());
+			fprintf(output, "\"}}");
+			isFirst = false;
+
+			ReadTrack(track, events);
+			for (size_t i = 0; i < events.size(); ++i) {
+				const ProfileEvent& event = events[i];
+				fprintf(output, ",\n{\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"", track.id, (event.begin - epoch) / 1000.0, (event.end - event.begin) / 1000.0);
+				WriteEscaped(output, event.name);
+				fprintf(output, "\"}");
+			}
+		}
+		fprintf(output, "\n]}\n");
+		return fclose(output) == 0;
+	}
+};
+
+///<summary>
+///Records zone from construction to end of scope on the calling thread, if profiler is enabled at construction
+///</summary>
+class ProfileScope {
+private:
+	const char* name;
+	long long begin;
+
+public:
+	ProfileScope(const char* zoneName) {
+		name = Profiler::Get().IsEnabled() ? zoneName : nullptr;
+		begin = name ? Profiler::Now() : 0;
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+	~ProfileScope() { if (name) { Profiler::Get().Record(name, begin, Profiler::Now()); } }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_DISABLED
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#endif
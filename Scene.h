@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include "Components.h"
+
+/*
+  - Demo scene header
+  - Scene content shared by window and headless entry points
+
+  - Scene.h:
+  - Contains realisations for DemoScene
+
+  - Dependencies:
+  - Components.h
+*/
+
+class DemoScene {
+public:
+	///<summary>
+	///Camera position points
+	///</summary>
+	std::vector<Vector3> points = Vector3::CirclePoints(4, 6, Vector3(0, 3.5f, 0), Quaternion::EulerAngles(0.07f, 0.5f, 0.059f));
+
+	Quaternion q = Quaternion::EulerAngles(0, PI / 4, 0);
+	MeshHandle m;
+	///<summary>
+	///Scene objects
+	///</summary>
+	World world;
+	Entity cuboid;
+	bool isAnimated = true;
+
+	Material matUnlit	= Material(Material::unlit);
+	Material matDiffuse = Material(Material::diffuse, 0.1f, 0.2f);
+	Material matRealist = Material(Material::realistic, 0.3f, 1.0f);
+	Material matOrient	= Material(Material::faceorient, 0.1f, 0.2f);
+
+	///<summary>
+	///Uploads scene meshes. Must be called after Renderer::init()
+	///</summary>
+	void Load(Renderer& renderer) {
+		m = renderer.UploadMesh(Mesh::GenerateCuboid(Vector3(2, 2, 2)));
+
+		cuboid = world.Create(World::transform | World::mesh | World::material | World::color);
+		world.SetTransform(cuboid, Transform(Vector3(0.1f), q));
+		world.SetMesh(cuboid, m);
+		world.SetMaterial(cuboid, matRealist);
+		world.SetColor(cuboid, Color(150, 220, 10));
+	}
+	///<summary>
+	///Advances scene objects by given time in seconds. Returns true if anything moved, so the scene has to be redrawn
+	///</summary>
+	bool Update(float deltaTime) {
+		isAnimated = world.ApplyVelocities(deltaTime);
+		return isAnimated;
+	}
+	///<summary>
+	///Returns true if last Update() moved objects, so next steps are expected to move them too. True before first update
+	///</summary>
+	bool IsAnimated(void) const { return isAnimated; }
+	///<summary>
+	///Sends scene to render. Must be called between Renderer::BeginFrame() and Renderer::EndFrame()
+	///</summary>
+	void Draw(Renderer& renderer) {
+		renderer.RenderGrid(-5, 5, 9, -5, 5, 9, 0, false, Color(50, 50, 50));
+		renderer.RenderPoints(points, Color(220, 150, 10));
+		renderer.RenderWorld(world);
+	}
+	///<summary>
+	///Frees scene meshes
+	///</summary>
+	void Unload(Renderer& renderer) {
+		world.Destroy(cuboid);
+		renderer.DestroyMesh(m);
+	}
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <string>
+#include "GLExtensions.h"
+
+/*
+  - Shaders header
+  - GLSL programs used by Renderer and a helper to build them
+
+  - Shaders.h:
+  - Contains realisations for ShaderProgram and GLSL sources of material shaders
+  - GLSL 3.30 core is used, so programs run on desktop drivers and on Mesa's software rasterizer (llvmpipe)
+
+  - Dependencies:
+  - GLExtensions.h
+*/
+
+///<summary>
+///Linked GLSL program
+///</summary>
+class ShaderProgram {
+private:
+	GLuint program = 0;
+	std::string log;
+
+	GLuint CompileStage(const GLExtensions& gl, GLenum type, const char* source) {
+		GLuint shader = gl.glCreateShader(type);
+		gl.glShaderSource(shader, 1, &source, nullptr);
+		gl.glCompileShader(shader);
+
+		GLint isCompiled = 0;
+		gl.glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+		if (!isCompiled) {
+			GLint length = 0;
+			gl.glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+			std::string stageLog(length > 0 ? length : 1, '\0');
+			gl.glGetShaderInfoLog(shader, (GLsizei)stageLog.size(), nullptr, &stageLog[0]);
+			log += (type == GL_VERTEX_SHADER ? "Vertex shader: " : "Fragment shader: ") + std::string(stageLog.c_str()) + "\n";
+
+			gl.glDeleteShader(shader);
+			return 0;
+		}
+		return shader;
+	}
+
+public:
+	///<summary>
+	///Compiles and links program. Attribute with index i in given list gets location i. Returns false on failure, see GetLog()
+	///</summary>
+	bool Create(const GLExtensions& gl, const char* vertexSource, const char* fragmentSource, const char* const* attributes, unsigned attributeCount) {
+		log.clear();
+		if (!gl.HasShaders()) { log = "GLSL programs are not supported"; return false; }
+
+		GLuint vertexShader = CompileStage(gl, GL_VERTEX_SHADER, vertexSource);
+		GLuint fragmentShader = CompileStage(gl, GL_FRAGMENT_SHADER, fragmentSource);
+		if (!vertexShader || !fragmentShader) {
+			if (vertexShader) { gl.glDeleteShader(vertexShader); }
+			if (fragmentShader) { gl.glDeleteShader(fragmentShader); }
+			return false;
+		}
+
+		program = gl.glCreateProgram();
+		gl.glAttachShader(program, vertexShader);
+		gl.glAttachShader(program, fragmentShader);
+		for (unsigned i = 0; i < attributeCount; ++i) { gl.glBindAttribLocation(program, i, attributes[i]); }
+		gl.glLinkProgram(program);
+		gl.glDeleteShader(vertexShader); // freed together with program
+		gl.glDeleteShader(fragmentShader);
+
+		GLint isLinked = 0;
+		gl.glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+		if (!isLinked) {
+			GLint length = 0;
+			gl.glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+			std::string linkLog(length > 0 ? length : 1, '\0');
+			gl.glGetProgramInfoLog(program, (GLsizei)linkLog.size(), nullptr, &linkLog[0]);
+			log += "Link: " + std::string(linkLog.c_str()) + "\n";
+
+			Destroy(gl);
+			return false;
+		}
+		return true;
+	}
+	void Destroy(const GLExtensions& gl) {
+		if (program) { gl.glDeleteProgram(program); }
+		program = 0;
+	}
+
+	bool IsValid(void) const { return program != 0; }
+	GLuint GetId(void) const { return program; }
+	///<summary>
+	///Returns compiler and linker messages of last Create()
+	///</summary>
+	const std::string& GetLog(void) const { return log; }
+	GLint GetUniform(const GLExtensions& gl, const char* name) const { return program ? gl.glGetUniformLocation(program, name) : -1; }
+};
+
+///<summary>
+///Binding point of Camera uniform block. Renderer fills the block once per frame
+///</summary>
+#define CameraBlockBinding	0
+
+///<summary>
+///Vertex attributes of MeshVertexShader in location order
+///</summary>
+static const char* const MeshAttributes[] = {
+	"vertexPosition", "vertexFaceNormal", "vertexColor"
+};
+///<summary>
+///Vertex attributes of InstancedVertexShader in location order
+///</summary>
+static const char* const InstancedAttributes[] = {
+	"vertexPosition", "vertexFaceNormal", "instancePosition", "instanceRotation", "instanceScale", "instanceColor"
+};
+
+///<summary>
+///Camera block, material uniforms and Shade() function shared by vertex shaders. MATERIAL_SHADER selects Material::Shader at compile time.
+///Lighting matches Renderer CPU shading: it is done per face at the provoking vertex, which holds face normal, and passed to fragments
+///without interpolation. Realistic material also depends on distance to camera, so Shade() gives its face term and the distance factor
+///is interpolated from every vertex and applied per fragment. Colors are in [0; 255] as in Color math
+///</summary>
+static const char* const MaterialLightingSource = R"GLSL(
+layout(std140) uniform Camera {
+	mat4 viewProjection;
+	vec4 cameraNormal;		// w is unused
+	vec4 cameraPosition;	// w is far clip distance
+};
+
+uniform float metallic;
+uniform float roughness;
+uniform float faceOrientFactor;
+uniform vec3 metalColor;
+uniform vec3 faceFrontColor;
+uniform vec3 faceBackColor;
+
+vec3 Rotate(vec4 q, vec3 v) { return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v); }
+
+float DiffusePoint(float angle) {
+	float r = 1.0 - roughness;
+	float a = r * abs(angle) - r;
+	return 1.0 - a * a;
+}
+
+float Angle(vec3 normal) { return dot(cameraNormal.xyz, normal) / (length(cameraNormal.xyz) + 1.0); }
+
+float DistanceFactor(vec3 worldPosition) { return clamp(distance(cameraPosition.xyz, worldPosition) / cameraPosition.w, 0.0, 1.0); }
+
+vec4 Shade(vec3 color, vec3 normal) {
+#if MATERIAL_SHADER == 0
+	return vec4(color / 255.0, 1.0);
+#elif MATERIAL_SHADER == 2
+	//Face term only, in [0; 255] units: fragment shader multiplies it by distance term, then floors and clamps
+	float angle = Angle(normal);
+	return vec4(floor(mix(color, metalColor, metallic)) * (abs(angle) * DiffusePoint(angle)), 1.0);
+#else
+	float angle = Angle(normal);
+#if MATERIAL_SHADER == 1
+	vec3 result = floor(mix(color, metalColor, metallic)) * DiffusePoint(angle);
+#else
+	vec3 result = floor(mix(color, angle < 0.0 ? faceFrontColor : faceBackColor, faceOrientFactor)) * DiffusePoint(angle);
+#endif
+	return vec4(clamp(floor(result), 0.0, 255.0) / 255.0, 1.0);
+#endif
+}
+)GLSL";
+
+///<summary>
+///Draws one transformed mesh. Transform is uniform, color is attribute: constant for the whole mesh, or per face for static batches
+///</summary>
+static const char* const MeshVertexShader = R"GLSL(
+in vec3 vertexPosition;
+in vec3 vertexFaceNormal;
+in vec4 vertexColor;
+
+uniform vec3 modelPosition;
+uniform vec4 modelRotation;
+uniform vec3 modelScale;
+
+flat out vec4 faceColor;
+#if MATERIAL_SHADER == 2
+out float vertexDistance;
+#endif
+
+void main() {
+	vec3 worldPosition = Rotate(modelRotation, vertexPosition * modelScale) + modelPosition;
+	gl_Position = viewProjection * vec4(worldPosition, 1.0);
+	faceColor = Shade(floor(vertexColor.rgb * 255.0 + 0.5), normalize(Rotate(modelRotation, vertexFaceNormal / modelScale)));
+#if MATERIAL_SHADER == 2
+	vertexDistance = DistanceFactor(worldPosition);
+#endif
+}
+)GLSL";
+
+///<summary>
+///Draws many transformed copies of one mesh. Transform and color are per-instance attributes
+///</summary>
+static const char* const InstancedVertexShader = R"GLSL(
+in vec3 vertexPosition;
+in vec3 vertexFaceNormal;
+in vec3 instancePosition;
+in vec4 instanceRotation;
+in vec3 instanceScale;
+in vec4 instanceColor;
+
+flat out vec4 faceColor;
+#if MATERIAL_SHADER == 2
+out float vertexDistance;
+#endif
+
+void main() {
+	vec3 worldPosition = Rotate(instanceRotation, vertexPosition * instanceScale) + instancePosition;
+	gl_Position = viewProjection * vec4(worldPosition, 1.0);
+	faceColor = Shade(floor(instanceColor.rgb * 255.0 + 0.5), normalize(Rotate(instanceRotation, vertexFaceNormal / instanceScale)));
+#if MATERIAL_SHADER == 2
+	vertexDistance = DistanceFactor(worldPosition);
+#endif
+}
+)GLSL";
+
+///<summary>
+///Writes face color. For realistic material it scales face term by interpolated distance factor, as CPU path does at every vertex
+///</summary>
+static const char* const MaterialFragmentShader = R"GLSL(
+flat in vec4 faceColor;
+#if MATERIAL_SHADER == 2
+in float vertexDistance;
+uniform float roughness;
+#endif
+out vec4 fragmentColor;
+
+void main() {
+#if MATERIAL_SHADER == 2
+	fragmentColor = vec4(clamp(floor(faceColor.rgb * (2.0 * roughness - vertexDistance)), 0.0, 255.0) / 255.0, 1.0);
+#else
+	fragmentColor = faceColor;
+#endif
+}
+)GLSL";
+
+///<summary>
+///Returns complete source of given vertex shader for material shader with given Material::Shader value
+///</summary>
+static std::string MaterialVertexSource(int shader, const char* vertexSource) {
+	return "#version 330 core\n#define MATERIAL_SHADER " + std::to_string(shader) + "\n" + MaterialLightingSource + vertexSource;
+}
+///<summary>
+///Returns complete source of fragment shader for material shader with given Material::Shader value
+///</summary>
+static std::string MaterialFragmentSource(int shader) {
+	return "#version 330 core\n#define MATERIAL_SHADER " + std::to_string(shader) + "\n" + MaterialFragmentShader;
+}
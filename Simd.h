@@ -0,0 +1,462 @@
+#pragma once
+
+#include <cstddef>
+#include "Geometry.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_TARGET_AVX2
+#endif
+
+/*
+  - SIMD header
+  - Runtime CPU feature dispatch and vectorized kernels over structure-of-arrays streams
+
+  - Simd.h:
+  - Contains realisations for Simd, VertexKernels, ColorKernels
+
+  - Dependencies:
+  - Geometry.h
+*/
+
+class Simd {
+public:
+	enum Level {
+		scalar = 0,
+		sse = 1,
+		avx2 = 2
+	};
+
+private:
+	static Level Detect(void) {
+#ifdef SIMD_X86
+		int info[4] = { 0, 0, 0, 0 };
+		Cpuid(info, 1, 0);
+		Level level = (info[3] & (1 << 26)) ? sse : scalar; // SSE2
+
+		const bool hasAvx = (info[2] & (1 << 28)) != 0;
+		const bool hasOsSave = (info[2] & (1 << 27)) != 0;
+		if (!hasAvx || !hasOsSave || (Xgetbv() & 0x6) != 0x6) { return level; } // OS must save XMM and YMM registers
+
+		Cpuid(info, 0, 0);
+		if (info[0] < 7) { return level; }
+		Cpuid(info, 7, 0);
+		if (info[1] & (1 << 5)) { level = avx2; }
+		return level;
+#else
+		return scalar;
+#endif
+	}
+#ifdef SIMD_X86
+	static void Cpuid(int info[4], int leaf, int subleaf) {
+#ifdef _MSC_VER
+		__cpuidex(info, leaf, subleaf);
+#else
+		unsigned a = 0, b = 0, c = 0, d = 0;
+		__cpuid_count(leaf, subleaf, a, b, c, d);
+		info[0] = (int)a; info[1] = (int)b; info[2] = (int)c; info[3] = (int)d;
+#endif
+	}
+	static unsigned long long Xgetbv(void) {
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned lo = 0, hi = 0;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		return ((unsigned long long)hi << 32) | lo;
+#endif
+	}
+#endif
+
+public:
+	///<summary>
+	///Returns best instruction set supported by current CPU. Detected once
+	///</summary>
+	static Level GetLevel(void) {
+		static const Level level = Detect();
+		return level;
+	}
+};
+
+///<summary>
+///Kernels, that transform whole x, y, z vertex streams. Source and destination streams may be the same
+///</summary>
+class VertexKernels {
+private:
+	///<summary>
+	///Copies upper 3x4 part of matrix as row-major coefficients: 3x3 linear part, then translation
+	///</summary>
+	static void AffineRows(const Matrix4x4& matrix, float m[12]) {
+		for (int r = 0; r < 3; ++r) {
+			m[r * 3] = matrix(r, 0); m[r * 3 + 1] = matrix(r, 1); m[r * 3 + 2] = matrix(r, 2);
+			m[9 + r] = matrix(r, 3);
+		}
+	}
+	static void ScaleScalar(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t i, size_t n, const Vector3& s) {
+		for (; i < n; ++i) { dx[i] = sx[i] * s.x; dy[i] = sy[i] * s.y; dz[i] = sz[i] * s.z; }
+	}
+	static void TranslateScalar(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t i, size_t n, const Vector3& t) {
+		for (; i < n; ++i) { dx[i] = sx[i] + t.x; dy[i] = sy[i] + t.y; dz[i] = sz[i] + t.z; }
+	}
+	static void RotateScalar(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t i, size_t n, const float m[9]) {
+		for (; i < n; ++i) {
+			const float x = sx[i], y = sy[i], z = sz[i];
+			dx[i] = m[0] * x + m[1] * y + m[2] * z;
+			dy[i] = m[3] * x + m[4] * y + m[5] * z;
+			dz[i] = m[6] * x + m[7] * y + m[8] * z;
+		}
+	}
+	static void AffineScalar(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t i, size_t n, const float m[12]) {
+		for (; i < n; ++i) {
+			const float x = sx[i], y = sy[i], z = sz[i];
+			dx[i] = m[0] * x + m[1] * y + m[2] * z + m[9];
+			dy[i] = m[3] * x + m[4] * y + m[5] * z + m[10];
+			dz[i] = m[6] * x + m[7] * y + m[8] * z + m[11];
+		}
+	}
+
+#ifdef SIMD_X86
+	static size_t ScaleSse(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Vector3& s) {
+		const __m128 kx = _mm_set1_ps(s.x), ky = _mm_set1_ps(s.y), kz = _mm_set1_ps(s.z);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(dx + i, _mm_mul_ps(_mm_loadu_ps(sx + i), kx));
+			_mm_storeu_ps(dy + i, _mm_mul_ps(_mm_loadu_ps(sy + i), ky));
+			_mm_storeu_ps(dz + i, _mm_mul_ps(_mm_loadu_ps(sz + i), kz));
+		}
+		return i;
+	}
+	static size_t TranslateSse(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Vector3& t) {
+		const __m128 kx = _mm_set1_ps(t.x), ky = _mm_set1_ps(t.y), kz = _mm_set1_ps(t.z);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(dx + i, _mm_add_ps(_mm_loadu_ps(sx + i), kx));
+			_mm_storeu_ps(dy + i, _mm_add_ps(_mm_loadu_ps(sy + i), ky));
+			_mm_storeu_ps(dz + i, _mm_add_ps(_mm_loadu_ps(sz + i), kz));
+		}
+		return i;
+	}
+	static size_t RotateSse(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const float m[9]) {
+		const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+		const __m128 m3 = _mm_set1_ps(m[3]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+		const __m128 m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]), m8 = _mm_set1_ps(m[8]);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 x = _mm_loadu_ps(sx + i), y = _mm_loadu_ps(sy + i), z = _mm_loadu_ps(sz + i);
+			_mm_storeu_ps(dx + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)), _mm_mul_ps(m2, z)));
+			_mm_storeu_ps(dy + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, x), _mm_mul_ps(m4, y)), _mm_mul_ps(m5, z)));
+			_mm_storeu_ps(dz + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m6, x), _mm_mul_ps(m7, y)), _mm_mul_ps(m8, z)));
+		}
+		return i;
+	}
+	static size_t AffineSse(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const float m[12]) {
+		const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+		const __m128 m3 = _mm_set1_ps(m[3]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+		const __m128 m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]), m8 = _mm_set1_ps(m[8]);
+		const __m128 tx = _mm_set1_ps(m[9]), ty = _mm_set1_ps(m[10]), tz = _mm_set1_ps(m[11]);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 x = _mm_loadu_ps(sx + i), y = _mm_loadu_ps(sy + i), z = _mm_loadu_ps(sz + i);
+			_mm_storeu_ps(dx + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)), _mm_mul_ps(m2, z)), tx));
+			_mm_storeu_ps(dy + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, x), _mm_mul_ps(m4, y)), _mm_mul_ps(m5, z)), ty));
+			_mm_storeu_ps(dz + i, _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m6, x), _mm_mul_ps(m7, y)), _mm_mul_ps(m8, z)), tz));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t ScaleAvx2(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Vector3& s) {
+		const __m256 kx = _mm256_set1_ps(s.x), ky = _mm256_set1_ps(s.y), kz = _mm256_set1_ps(s.z);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(dx + i, _mm256_mul_ps(_mm256_loadu_ps(sx + i), kx));
+			_mm256_storeu_ps(dy + i, _mm256_mul_ps(_mm256_loadu_ps(sy + i), ky));
+			_mm256_storeu_ps(dz + i, _mm256_mul_ps(_mm256_loadu_ps(sz + i), kz));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t TranslateAvx2(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Vector3& t) {
+		const __m256 kx = _mm256_set1_ps(t.x), ky = _mm256_set1_ps(t.y), kz = _mm256_set1_ps(t.z);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(dx + i, _mm256_add_ps(_mm256_loadu_ps(sx + i), kx));
+			_mm256_storeu_ps(dy + i, _mm256_add_ps(_mm256_loadu_ps(sy + i), ky));
+			_mm256_storeu_ps(dz + i, _mm256_add_ps(_mm256_loadu_ps(sz + i), kz));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t RotateAvx2(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const float m[9]) {
+		const __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+		const __m256 m3 = _mm256_set1_ps(m[3]), m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]);
+		const __m256 m6 = _mm256_set1_ps(m[6]), m7 = _mm256_set1_ps(m[7]), m8 = _mm256_set1_ps(m[8]);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 x = _mm256_loadu_ps(sx + i), y = _mm256_loadu_ps(sy + i), z = _mm256_loadu_ps(sz + i);
+			_mm256_storeu_ps(dx + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m1, y)), _mm256_mul_ps(m2, z)));
+			_mm256_storeu_ps(dy + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m3, x), _mm256_mul_ps(m4, y)), _mm256_mul_ps(m5, z)));
+			_mm256_storeu_ps(dz + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m6, x), _mm256_mul_ps(m7, y)), _mm256_mul_ps(m8, z)));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t AffineAvx2(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const float m[12]) {
+		const __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+		const __m256 m3 = _mm256_set1_ps(m[3]), m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]);
+		const __m256 m6 = _mm256_set1_ps(m[6]), m7 = _mm256_set1_ps(m[7]), m8 = _mm256_set1_ps(m[8]);
+		const __m256 tx = _mm256_set1_ps(m[9]), ty = _mm256_set1_ps(m[10]), tz = _mm256_set1_ps(m[11]);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 x = _mm256_loadu_ps(sx + i), y = _mm256_loadu_ps(sy + i), z = _mm256_loadu_ps(sz + i);
+			_mm256_storeu_ps(dx + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m1, y)), _mm256_mul_ps(m2, z)), tx));
+			_mm256_storeu_ps(dy + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m3, x), _mm256_mul_ps(m4, y)), _mm256_mul_ps(m5, z)), ty));
+			_mm256_storeu_ps(dz + i, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m6, x), _mm256_mul_ps(m7, y)), _mm256_mul_ps(m8, z)), tz));
+		}
+		return i;
+	}
+#endif
+
+public:
+	///<summary>
+	///Multiplies each vertex by scale on each axis
+	///</summary>
+	static void Scale(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Vector3& scale) {
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = ScaleAvx2(sx, sy, sz, dx, dy, dz, n, scale); break;
+		case Simd::sse: i = ScaleSse(sx, sy, sz, dx, dy, dz, n, scale); break;
+		default: break;
+		}
+#endif
+		ScaleScalar(sx, sy, sz, dx, dy, dz, i, n, scale);
+	}
+	///<summary>
+	///Rotates each vertex by given quaternion
+	///</summary>
+	static void Rotate(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Quaternion& rotation) {
+		float m[12];
+		AffineRows(Matrix4x4::Rotation(rotation), m);
+
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = RotateAvx2(sx, sy, sz, dx, dy, dz, n, m); break;
+		case Simd::sse: i = RotateSse(sx, sy, sz, dx, dy, dz, n, m); break;
+		default: break;
+		}
+#endif
+		RotateScalar(sx, sy, sz, dx, dy, dz, i, n, m);
+	}
+	///<summary>
+	///Shifts each vertex by given Vector3
+	///</summary>
+	static void Translate(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Vector3& translation) {
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = TranslateAvx2(sx, sy, sz, dx, dy, dz, n, translation); break;
+		case Simd::sse: i = TranslateSse(sx, sy, sz, dx, dy, dz, n, translation); break;
+		default: break;
+		}
+#endif
+		TranslateScalar(sx, sy, sz, dx, dy, dz, i, n, translation);
+	}
+	///<summary>
+	///Transforms each vertex by affine matrix in one pass. Use Matrix4x4::TRS() to scale, rotate and shift at once
+	///</summary>
+	static void Transform(const float* sx, const float* sy, const float* sz, float* dx, float* dy, float* dz, size_t n, const Matrix4x4& matrix) {
+		float m[12];
+		AffineRows(matrix, m);
+
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = AffineAvx2(sx, sy, sz, dx, dy, dz, n, m); break;
+		case Simd::sse: i = AffineSse(sx, sy, sz, dx, dy, dz, n, m); break;
+		default: break;
+		}
+#endif
+		AffineScalar(sx, sy, sz, dx, dy, dz, i, n, m);
+	}
+};
+
+///<summary>
+///Kernels over structure-of-arrays color streams: separate r, g, b float channels in [0; 255] scale, as in Color math. Source and destination streams may be the same
+///</summary>
+class ColorKernels {
+private:
+	static void LerpScalar(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t i, size_t n, const Vector3& target, float t) {
+		for (; i < n; ++i) { dr[i] = sr[i] + (target.x - sr[i]) * t; dg[i] = sg[i] + (target.y - sg[i]) * t; db[i] = sb[i] + (target.z - sb[i]) * t; }
+	}
+	static void ScaleScalar(const float* sr, const float* sg, const float* sb, const float* factors, float* dr, float* dg, float* db, size_t i, size_t n) {
+		for (; i < n; ++i) { dr[i] = sr[i] * factors[i]; dg[i] = sg[i] * factors[i]; db[i] = sb[i] * factors[i]; }
+	}
+	static float SaturateScalar(float value) { return value < 0 ? 0 : value > 255 ? 255 : value; }
+	static void SaturateScalar(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t i, size_t n) {
+		for (; i < n; ++i) { dr[i] = SaturateScalar(sr[i]); dg[i] = SaturateScalar(sg[i]); db[i] = SaturateScalar(sb[i]); }
+	}
+	static void PackScalar(const float* sr, const float* sg, const float* sb, unsigned char* rgba, size_t i, size_t n) {
+		for (; i < n; ++i) {
+			rgba[i * 4] = (unsigned char)SaturateScalar(sr[i]); rgba[i * 4 + 1] = (unsigned char)SaturateScalar(sg[i]); rgba[i * 4 + 2] = (unsigned char)SaturateScalar(sb[i]);
+			rgba[i * 4 + 3] = 255;
+		}
+	}
+
+#ifdef SIMD_X86
+	static size_t LerpSse(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t n, const Vector3& target, float t) {
+		const __m128 kr = _mm_set1_ps(target.x), kg = _mm_set1_ps(target.y), kb = _mm_set1_ps(target.z), kt = _mm_set1_ps(t);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 r = _mm_loadu_ps(sr + i), g = _mm_loadu_ps(sg + i), b = _mm_loadu_ps(sb + i);
+			_mm_storeu_ps(dr + i, _mm_add_ps(r, _mm_mul_ps(_mm_sub_ps(kr, r), kt)));
+			_mm_storeu_ps(dg + i, _mm_add_ps(g, _mm_mul_ps(_mm_sub_ps(kg, g), kt)));
+			_mm_storeu_ps(db + i, _mm_add_ps(b, _mm_mul_ps(_mm_sub_ps(kb, b), kt)));
+		}
+		return i;
+	}
+	static size_t ScaleSse(const float* sr, const float* sg, const float* sb, const float* factors, float* dr, float* dg, float* db, size_t n) {
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 f = _mm_loadu_ps(factors + i);
+			_mm_storeu_ps(dr + i, _mm_mul_ps(_mm_loadu_ps(sr + i), f));
+			_mm_storeu_ps(dg + i, _mm_mul_ps(_mm_loadu_ps(sg + i), f));
+			_mm_storeu_ps(db + i, _mm_mul_ps(_mm_loadu_ps(sb + i), f));
+		}
+		return i;
+	}
+	static size_t SaturateSse(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t n) {
+		const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(dr + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(sr + i), lo), hi));
+			_mm_storeu_ps(dg + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(sg + i), lo), hi));
+			_mm_storeu_ps(db + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(sb + i), lo), hi));
+		}
+		return i;
+	}
+	static size_t PackSse(const float* sr, const float* sg, const float* sb, unsigned char* rgba, size_t n) {
+		const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			//Saturated channels fit in a byte, so they are shifted into place of 32-bit pixel without packing instructions
+			const __m128i r = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(sr + i), lo), hi));
+			const __m128i g = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(sg + i), lo), hi));
+			const __m128i b = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(sb + i), lo), hi));
+			const __m128i pixels = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), alpha));
+			_mm_storeu_si128((__m128i*)(rgba + i * 4), pixels);
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t LerpAvx2(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t n, const Vector3& target, float t) {
+		const __m256 kr = _mm256_set1_ps(target.x), kg = _mm256_set1_ps(target.y), kb = _mm256_set1_ps(target.z), kt = _mm256_set1_ps(t);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 r = _mm256_loadu_ps(sr + i), g = _mm256_loadu_ps(sg + i), b = _mm256_loadu_ps(sb + i);
+			_mm256_storeu_ps(dr + i, _mm256_add_ps(r, _mm256_mul_ps(_mm256_sub_ps(kr, r), kt)));
+			_mm256_storeu_ps(dg + i, _mm256_add_ps(g, _mm256_mul_ps(_mm256_sub_ps(kg, g), kt)));
+			_mm256_storeu_ps(db + i, _mm256_add_ps(b, _mm256_mul_ps(_mm256_sub_ps(kb, b), kt)));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t ScaleAvx2(const float* sr, const float* sg, const float* sb, const float* factors, float* dr, float* dg, float* db, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 f = _mm256_loadu_ps(factors + i);
+			_mm256_storeu_ps(dr + i, _mm256_mul_ps(_mm256_loadu_ps(sr + i), f));
+			_mm256_storeu_ps(dg + i, _mm256_mul_ps(_mm256_loadu_ps(sg + i), f));
+			_mm256_storeu_ps(db + i, _mm256_mul_ps(_mm256_loadu_ps(sb + i), f));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t SaturateAvx2(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t n) {
+		const __m256 lo = _mm256_setzero_ps(), hi = _mm256_set1_ps(255.0f);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(dr + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(sr + i), lo), hi));
+			_mm256_storeu_ps(dg + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(sg + i), lo), hi));
+			_mm256_storeu_ps(db + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(sb + i), lo), hi));
+		}
+		return i;
+	}
+	SIMD_TARGET_AVX2 static size_t PackAvx2(const float* sr, const float* sg, const float* sb, unsigned char* rgba, size_t n) {
+		const __m256 lo = _mm256_setzero_ps(), hi = _mm256_set1_ps(255.0f);
+		const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i r = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(sr + i), lo), hi));
+			const __m256i g = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(sg + i), lo), hi));
+			const __m256i b = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(sb + i), lo), hi));
+			const __m256i pixels = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), alpha));
+			_mm256_storeu_si256((__m256i*)(rgba + i * 4), pixels);
+		}
+		return i;
+	}
+#endif
+
+public:
+	///<summary>
+	///Linear interpolates each color to target color with parameter t = [0; 1], as Color::Lerp() before truncation
+	///</summary>
+	static void Lerp(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t n, const Vector3& target, float t) {
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = LerpAvx2(sr, sg, sb, dr, dg, db, n, target, t); break;
+		case Simd::sse: i = LerpSse(sr, sg, sb, dr, dg, db, n, target, t); break;
+		default: break;
+		}
+#endif
+		LerpScalar(sr, sg, sb, dr, dg, db, i, n, target, t);
+	}
+	///<summary>
+	///Multiplies each color by its own factor, such as lighting intensity
+	///</summary>
+	static void Scale(const float* sr, const float* sg, const float* sb, const float* factors, float* dr, float* dg, float* db, size_t n) {
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = ScaleAvx2(sr, sg, sb, factors, dr, dg, db, n); break;
+		case Simd::sse: i = ScaleSse(sr, sg, sb, factors, dr, dg, db, n); break;
+		default: break;
+		}
+#endif
+		ScaleScalar(sr, sg, sb, factors, dr, dg, db, i, n);
+	}
+	///<summary>
+	///Clamps each channel to [0; 255]
+	///</summary>
+	static void Saturate(const float* sr, const float* sg, const float* sb, float* dr, float* dg, float* db, size_t n) {
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = SaturateAvx2(sr, sg, sb, dr, dg, db, n); break;
+		case Simd::sse: i = SaturateSse(sr, sg, sb, dr, dg, db, n); break;
+		default: break;
+		}
+#endif
+		SaturateScalar(sr, sg, sb, dr, dg, db, i, n);
+	}
+	///<summary>
+	///Writes colors as 4-byte RGBA pixels with alpha 255. Channels are saturated and truncated, same as Color(long, long, long)
+	///</summary>
+	static void PackRGBA8(const float* sr, const float* sg, const float* sb, unsigned char* rgba, size_t n) {
+		size_t i = 0;
+#ifdef SIMD_X86
+		switch (Simd::GetLevel()) {
+		case Simd::avx2: i = PackAvx2(sr, sg, sb, rgba, n); break;
+		case Simd::sse: i = PackSse(sr, sg, sb, rgba, n); break;
+		default: break;
+		}
+#endif
+		PackScalar(sr, sg, sb, rgba, i, n);
+	}
+};
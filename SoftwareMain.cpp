@@ -33,24 +33,31 @@ LRESULT CALLBACK MainWndProcedure(HWND hWnd, UINT message, WPARAM wParam, LPARAM
 			CheckMenuItem(CameraModeMenu, 0, MF_BYPOSITION | MF_UNCHECKED);
 			break;
 		case CMDCameraPos1:
-			renderer.camera.SetCameraPosition(points[0]);
+			renderer.camera.SetCameraPosition(scene.points[0]);
 			cameraIsFree = false;
 			break;
 		case CMDCameraPos2:
-			renderer.camera.SetCameraPosition(points[1]);
+			renderer.camera.SetCameraPosition(scene.points[1]);
 			cameraIsFree = false;
 			break;
 		case CMDCameraPos3:
-			renderer.camera.SetCameraPosition(points[2]);
+			renderer.camera.SetCameraPosition(scene.points[2]);
 			cameraIsFree = false;
 			break;
 		case CMDCameraPos4:
-			renderer.camera.SetCameraPosition(points[3]);
+			renderer.camera.SetCameraPosition(scene.points[3]);
 			cameraIsFree = false;
 			break;
 		case CMDCameraPosFree:
 			cameraIsFree = true;
 			break;
+		case CMDFrameContinuous:
+		case CMDFrameVSync:
+		case CMDFrameOnDemand:
+			scheduler.SetMode(wParam == CMDFrameVSync ? FrameScheduler::vsync : wParam == CMDFrameOnDemand ? FrameScheduler::onDemand : FrameScheduler::continuous);
+			renderContext.SetSwapInterval(wParam == CMDFrameVSync ? 1 : 0);
+			for (UINT i = 0; i < 3; ++i) { CheckMenuItem(FrameModeMenu, i, MF_BYPOSITION | (i == wParam - CMDFrameContinuous ? MF_CHECKED : MF_UNCHECKED)); }
+			break;
 		default: return 0;
 		}
 		return 0;
@@ -62,8 +69,14 @@ LRESULT CALLBACK MainWndProcedure(HWND hWnd, UINT message, WPARAM wParam, LPARAM
 	case WM_CREATE:
 		MainWndAddMenus(hWnd);
 		CheckMenuItem(CameraModeMenu, 1, MF_BYPOSITION | MF_CHECKED);
+		CheckMenuItem(FrameModeMenu, 0, MF_BYPOSITION | MF_CHECKED);
 		break;
 
+	case WM_PAINT:
+	case WM_SIZE:
+		scheduler.RequestRedraw();
+		return DefWindowProc(hWnd, message, wParam, lParam);
+
 	default: return DefWindowProc(hWnd, message, wParam, lParam);
 	}
 	return 0;
@@ -75,45 +88,58 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmd
 
 	if (!MainWndRegisterClass(hInstance, (HBRUSH)COLOR_WINDOW, LoadCursor(NULL, IDC_ARROW), LoadIcon(NULL, IDI_QUESTION))) { MessageBox(NULL, L"RegisterClass() failed", L"Error", MB_ICONERROR | MB_OK); return FALSE; }
 	if (!CreateRenderContext(hInstance, L"OpenGL App")) { MessageBox(NULL, L"CreateRenderContext() failed", L"Error", MB_ICONERROR | MB_OK); return FALSE; }
-	wglMakeCurrent(hDC, hRC);
+	renderContext.MakeCurrent();
+	renderContext.SetSwapInterval(0);
 	ShowWindow(hWnd, nCmdShow);
 	UpdateWindow(hWnd);
 
 	renderer.init();
-
-	Quaternion q = Quaternion::EulerAngles(0, PI / 4, 0);
-	Mesh m = Mesh::GenerateCuboid(Vector3(2, 2, 2));
-	
-	Material matUnlit	= Material(Material::unlit);
-	Material matDiffuse = Material(Material::diffuse, 0.1f, 0.2f);
-	Material matRealist = Material(Material::realistic, 0.3f, 1.0f);
-	Material matOrient	= Material(Material::faceorient, 0.1f, 0.2f);
+	scene.Load(renderer);
 
 	float time = 0;
+	unsigned cameraVersion = renderer.camera.GetVersion();
 
-	MSG msg;
+	MSG msg = { 0 };
+	bool isRunning = true;
 
-	while (GetMessage(&msg, nullptr, 0, 0)) {
-		TranslateMessage(&msg);
-		DispatchMessage(&msg);
+	while (isRunning) {
+		/* on-demand mode sleeps until input, or until next simulation step while something animates */
+		const long timeout = scheduler.GetWaitTimeout();
+		if (timeout != 0) { MsgWaitForMultipleObjects(0, nullptr, FALSE, timeout == FrameScheduler::InfiniteWait ? INFINITE : (DWORD)timeout, QS_ALLINPUT); }
 
-		
-		if (cameraIsFree) {
-			renderer.camera.SetCameraPosition(Vector3(5 * cosf(time), 4, 5 * sinf(time)));
-			time += 0.01793473f;
+		while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) { isRunning = false; break; }
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+		if (!isRunning) { break; }
+
+		/*				Simulation with fixed timestep			*/
+		for (unsigned steps = scheduler.BeginFrame(); steps > 0; --steps) {
+			if (cameraIsFree) {
+				renderer.camera.SetCameraPosition(Vector3(5 * cosf(time), 4, 5 * sinf(time)));
+				time += FreeCameraSpeed * (float)scheduler.GetFixedStep();
+			}
+			if (scene.Update((float)scheduler.GetFixedStep())) { scheduler.RequestRedraw(); }
+		}
+		scheduler.SetAnimating(cameraIsFree || scene.IsAnimated());
+		if (renderer.camera.GetVersion() != cameraVersion) {
+			cameraVersion = renderer.camera.GetVersion();
+			scheduler.RequestRedraw();
 		}
 
+		if (scheduler.ShouldRender()) {
+			/*				Frame draw begin			*/
+			renderer.BeginFrame();
 
-		/*				Frame draw begin			*/
-		renderer.BeginFrame();
-
-		renderer.RenderGrid(-5, 5, 9, -5, 5, 9, 0, false, Color(50, 50, 50));
-		renderer.RenderPoints(points, Color(220, 150, 10));
-		renderer.RenderMesh(m, Vector3(0.1f), q, Color(150, 220, 10), matRealist);
-
-		renderer.EndFrame();
-		/*				Frame draw end				*/
+			scene.Draw(renderer);
 
+			renderer.EndFrame();
+			renderContext.Present();
+			/*				Frame draw end				*/
+		}
+		scheduler.EndFrame();
+		scheduler.WaitForNextFrame();
 	}
 	return (int)msg.wParam;
 }
\ No newline at end of file
@@ -9,7 +9,8 @@
   - Contains WINMAIN and WindowProcedure realisations
 */
 
-#include "Components.h"
+#include "Scene.h"
+#include "FrameScheduler.h"
 
 #define MainWindowSizeX		1600
 #define MainWindowSizeY		958
@@ -26,28 +27,35 @@
 #define CMDCameraPosFree	14
 #define CMDCameraOrtho		15
 #define CMDCameraPersp		16
+#define CMDFrameContinuous	17
+#define CMDFrameVSync		18
+#define CMDFrameOnDemand	19
 
+#define FrameTargetRate		60
+#define SimulationRate		120
+#define FreeCameraSpeed		1.0760838f		/* radians per second */
 
-HDC     hDC;					/* device context */
-HGLRC   hRC;					/* render context (opengl context) */
+
+RenderContext renderContext;	/* render context (opengl context) */
 HWND    hWnd, GLWnd;			/* window */
 
 bool cameraIsFree = false;
-HMENU	CameraPosMenu, CameraModeMenu;
+HMENU	CameraPosMenu, CameraModeMenu, FrameModeMenu;
 
 //Scene renderer component
 Renderer renderer = Renderer(Camera(Vector3(3, 4, 3), Vector3(0, 1, 0)));
 
-//Camera position points
-std::vector<Vector3> points = Vector3::CirclePoints(4, 6, Vector3(0, 3.5f, 0), Quaternion::EulerAngles(0.07f, 0.5f, 0.059f));
+//Scene content
+DemoScene scene;
+
+//Decides when frames are rendered
+FrameScheduler scheduler = FrameScheduler(FrameScheduler::continuous, FrameTargetRate, SimulationRate);
 
 LRESULT CALLBACK MainWndProcedure(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow);
 
 void ExitSoftware() {			/* Application close function */
-	wglMakeCurrent(hDC, NULL);
-	wglDeleteContext(hRC);
-	ReleaseDC(hWnd, hDC);
+	renderContext.Destroy();
 	DestroyWindow(hWnd);
 	PostQuitMessage(0);
 }
@@ -75,23 +83,8 @@ BOOL CreateRenderContext(HINSTANCE hInstance, LPCWSTR mainWndName) {
 	hWnd = CreateWindowW(L"SoftwareMain", mainWndName, WS_OVERLAPPEDWINDOW | WS_CLIPSIBLINGS | WS_CLIPCHILDREN, 100, 100, MainWindowSizeX, MainWindowSizeY, nullptr, nullptr, hInstance, nullptr);
 	GLWnd = CreateWindowA("static", NULL, WS_VISIBLE | WS_CHILD, GLWindowPosX, GLWindowPosY, GLWindowSizeX, GLWindowSizeY, hWnd, NULL, NULL, NULL);
 	if (!hWnd) { return FALSE; }
-	
-	PIXELFORMATDESCRIPTOR pixelFormatDescriptor = { 0 };
-	int                   pixelFormat;
-	hDC = GetDC(GLWnd);
-
-	pixelFormatDescriptor.nSize = sizeof(PIXELFORMATDESCRIPTOR);
-	pixelFormatDescriptor.nVersion = 1;
-	pixelFormatDescriptor.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL;
-	pixelFormatDescriptor.iPixelType = PFD_TYPE_RGBA;
-	pixelFormatDescriptor.cColorBits = 32;
-	pixelFormat = ChoosePixelFormat(hDC, &pixelFormatDescriptor);
-
-	SetPixelFormat(hDC, pixelFormat, &pixelFormatDescriptor);
-	DescribePixelFormat(hDC, pixelFormat, sizeof(PIXELFORMATDESCRIPTOR), &pixelFormatDescriptor);
-	hRC = wglCreateContext(hDC);
-
-	return (hRC != NULL);
+
+	return renderContext.Create(GLWnd);
 }
 
 void MainWndAddMenus(HWND hWndMain) {
@@ -99,6 +92,7 @@ void MainWndAddMenus(HWND hWndMain) {
 	
 	CameraPosMenu = CreateMenu();
 	CameraModeMenu = CreateMenu();
+	FrameModeMenu = CreateMenu();
 	
 	AppendMenu(CameraPosMenu, MF_STRING, CMDCameraPos1, L"Position 1");
 	AppendMenu(CameraPosMenu, MF_STRING, CMDCameraPos2, L"Position 2");
@@ -109,8 +103,13 @@ void MainWndAddMenus(HWND hWndMain) {
 	AppendMenu(CameraModeMenu, MF_STRING, CMDCameraOrtho, L"Ortho");
 	AppendMenu(CameraModeMenu, MF_STRING, CMDCameraPersp, L"Perspective");
 
+	AppendMenu(FrameModeMenu, MF_STRING, CMDFrameContinuous, L"Continuous");
+	AppendMenu(FrameModeMenu, MF_STRING, CMDFrameVSync, L"VSync");
+	AppendMenu(FrameModeMenu, MF_STRING, CMDFrameOnDemand, L"On demand");
+
 	AppendMenu(RootMenu, MF_POPUP, (UINT_PTR)CameraPosMenu, L"Position");
 	AppendMenu(RootMenu, MF_POPUP, (UINT_PTR)CameraModeMenu, L"View mode");
+	AppendMenu(RootMenu, MF_POPUP, (UINT_PTR)FrameModeMenu, L"Frame mode");
 
 	SetMenu(hWndMain, RootMenu);
 }
\ No newline at end of file